@@ -0,0 +1,145 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef DS_DISTANCEMATRIX_H
+#define DS_DISTANCEMATRIX_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+/// Distance matrix kernel shared by the CVRP and VRPTW applications (their Data::buildDistanceMatrix)
+namespace ds
+{
+    /// Contiguous row-major matrix whose rows start at a cache line boundary
+    template<typename T>
+    class AlignedMatrix
+    {
+    public:
+        static const std::size_t cacheLineSize = 64;
+
+        AlignedMatrix() : storage(), stride(0), offset(0)
+        {}
+
+        void resize(int nbRows, int nbCols)
+        {
+            const std::size_t rowBytes = nbCols * sizeof(T);
+            stride = ((rowBytes + cacheLineSize - 1) / cacheLineSize) * cacheLineSize / sizeof(T);
+            storage.assign(nbRows * stride + cacheLineSize / sizeof(T), T());
+            auto address = reinterpret_cast<std::uintptr_t>(storage.data());
+            offset = ((cacheLineSize - address % cacheLineSize) % cacheLineSize) / sizeof(T);
+        }
+
+        void clear()
+        {
+            std::vector<T>().swap(storage);
+            stride = offset = 0;
+        }
+
+        bool empty() const { return storage.empty(); }
+        std::size_t rowStride() const { return stride; }
+        T * row(int i) { return storage.data() + offset + i * stride; }
+        const T * row(int i) const { return storage.data() + offset + i * stride; }
+
+    private:
+        std::vector<T> storage;
+        std::size_t stride;
+        std::size_t offset;
+    };
+
+    /// Rounding of the distances of an instance (each application maps its own RoundType on it)
+    enum class DistanceRounding
+    {
+        None,
+        Closest,
+        Up,
+        OneDecimal
+    };
+
+    inline double getDistance(double x1, double y1, double x2, double y2, DistanceRounding rounding)
+    {
+        double distance = sqrt((x2-x1) * (x2-x1) + (y2-y1) * (y2-y1) );
+        if (rounding == DistanceRounding::Closest)
+            return round(distance);
+        else if (rounding == DistanceRounding::Up)
+            return ceil(distance);
+        else if (rounding == DistanceRounding::OneDecimal)
+            return floor(distance * 10) / 10;
+        return distance;
+    }
+
+    /// Distances from (x1, y1) to all nodes, written either in realRow or in intRow (rows of an AlignedMatrix, and
+    /// xCoord, yCoord aligned in the same way). The vector kernels are only compiled with -mavx2 or -msse4.1 (options
+    /// CVRP_ENABLE_SIMD and VRPTW_ENABLE_SIMD). They give the same values as getDistance(): same operations without
+    /// contraction, and round() of a non-negative value is computed as floor(d) + (d - floor(d) >= 0.5)
+    inline void fillDistanceRow(double x1, double y1, const double * xCoord, const double * yCoord, int nbNodes,
+                                DistanceRounding rounding, double * realRow, std::int32_t * intRow)
+    {
+        int j = 0;
+#if defined(__AVX2__)
+        const __m256d x1v = _mm256_set1_pd(x1), y1v = _mm256_set1_pd(y1);
+        const __m256d half = _mm256_set1_pd(0.5), one = _mm256_set1_pd(1.0), ten = _mm256_set1_pd(10.0);
+        for (; j + 4 <= nbNodes; j += 4)
+        {
+            __m256d dx = _mm256_sub_pd(_mm256_load_pd(xCoord + j), x1v);
+            __m256d dy = _mm256_sub_pd(_mm256_load_pd(yCoord + j), y1v);
+            __m256d dist = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+            if (rounding == DistanceRounding::Closest)
+            {
+                __m256d fl = _mm256_floor_pd(dist);
+                __m256d up = _mm256_and_pd(_mm256_cmp_pd(_mm256_sub_pd(dist, fl), half, _CMP_GE_OQ), one);
+                dist = _mm256_add_pd(fl, up);
+            }
+            else if (rounding == DistanceRounding::Up)
+                dist = _mm256_ceil_pd(dist);
+            else if (rounding == DistanceRounding::OneDecimal)
+                dist = _mm256_div_pd(_mm256_floor_pd(_mm256_mul_pd(dist, ten)), ten);
+            if (intRow != nullptr)
+                _mm_store_si128(reinterpret_cast<__m128i *>(intRow + j), _mm256_cvtpd_epi32(dist));
+            else
+                _mm256_store_pd(realRow + j, dist);
+        }
+#elif defined(__SSE4_1__)
+        const __m128d x1v = _mm_set1_pd(x1), y1v = _mm_set1_pd(y1);
+        const __m128d half = _mm_set1_pd(0.5), one = _mm_set1_pd(1.0), ten = _mm_set1_pd(10.0);
+        for (; j + 2 <= nbNodes; j += 2)
+        {
+            __m128d dx = _mm_sub_pd(_mm_load_pd(xCoord + j), x1v);
+            __m128d dy = _mm_sub_pd(_mm_load_pd(yCoord + j), y1v);
+            __m128d dist = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+            if (rounding == DistanceRounding::Closest)
+            {
+                __m128d fl = _mm_floor_pd(dist);
+                __m128d up = _mm_and_pd(_mm_cmpge_pd(_mm_sub_pd(dist, fl), half), one);
+                dist = _mm_add_pd(fl, up);
+            }
+            else if (rounding == DistanceRounding::Up)
+                dist = _mm_ceil_pd(dist);
+            else if (rounding == DistanceRounding::OneDecimal)
+                dist = _mm_div_pd(_mm_floor_pd(_mm_mul_pd(dist, ten)), ten);
+            if (intRow != nullptr)
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(intRow + j), _mm_cvtpd_epi32(dist));
+            else
+                _mm_store_pd(realRow + j, dist);
+        }
+#endif
+        for (; j < nbNodes; ++j)
+        {
+            double dist = getDistance(x1, y1, xCoord[j], yCoord[j], rounding);
+            if (intRow != nullptr)
+                intRow[j] = (std::int32_t) dist;
+            else
+                realRow[j] = dist;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef CVRP_JOAO_BENCHMARKUTILS_H
+#define CVRP_JOAO_BENCHMARKUTILS_H
+
+#include "Data.h"
+#include "SparseXSolution.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    // Random instance in the Data singleton: customers with integer coordinates uniform in [0, 1000]^2 and demands
+    // in [1, 100], the depot at the centre, and distances rounded to the closest integer (as for the X instances).
+    // The distance matrix is not built
+    inline cvrp_joao::Data & randomInstance(int nbCustomers, unsigned seed)
+    {
+        auto & data = cvrp_joao::Data::getInstance();
+        std::mt19937 generator(seed);
+        std::uniform_int_distribution<int> coordinate(0, 1000), demand(1, 100);
+        data.name = "random-" + std::to_string(nbCustomers) + "-" + std::to_string(seed);
+        data.nbCustomers = nbCustomers;
+        data.customers.assign(1, cvrp_joao::Customer());
+        for (int i = 1; i <= nbCustomers; i++)
+            data.customers.emplace_back(i, demand(generator), coordinate(generator), coordinate(generator));
+        data.depot_x = 500.0;
+        data.depot_y = 500.0;
+        data.veh_capacity = 500;
+        data.roundType = cvrp_joao::Data::ROUND_CLOSEST;
+        return data;
+    }
+
+    // Random routes over the customers 1..nbCustomers: a random order of the customers split in routes of 2 to 12
+    inline std::vector<std::vector<int>> randomRoutes(int nbCustomers, std::mt19937 & generator)
+    {
+        std::vector<int> order(nbCustomers);
+        std::iota(order.begin(), order.end(), 1);
+        std::shuffle(order.begin(), order.end(), generator);
+        std::uniform_int_distribution<int> routeSize(2, 12);
+        std::vector<std::vector<int>> routes;
+        for (int k = 0; k < nbCustomers; )
+        {
+            int end = std::min(nbCustomers, k + routeSize(generator));
+            routes.emplace_back(order.begin() + k, order.begin() + end);
+            k = end;
+        }
+        return routes;
+    }
+
+    // Fractional LP solution x = sum of weights[s] * x(solutions[s]), where each solution is a set of routes
+    // starting and ending at the depot (node 0)
+    inline void routesToLPSolution(int nbCustomers, const std::vector<std::vector<std::vector<int>>> & solutions,
+                                   const std::vector<double> & weights, cvrp_joao::SparseXSolution & xSolution)
+    {
+        std::map<std::pair<int, int>, double> values;
+        for (size_t s = 0; s < solutions.size(); s++)
+            for (const auto & route : solutions[s])
+                for (size_t k = 0; k <= route.size(); k++)
+                {
+                    int i = (k == 0) ? 0 : route[k - 1], j = (k == route.size()) ? 0 : route[k];
+                    values[std::make_pair(std::min(i, j), std::max(i, j))] += weights[s];
+                }
+        xSolution.clear(nbCustomers + 1);
+        for (const auto & value : values)
+            xSolution.addEdge(value.first.first, value.first.second, value.second);
+        xSolution.finalize();
+    }
+
+    // Root fractional solution saved by the branching (see --rootFracSolutionFilePath), as "i j value" lines.
+    // Returns false if the file cannot be read or is empty
+    inline bool readRootFracSolution(const std::string & fileName, cvrp_joao::SparseXSolution & xSolution)
+    {
+        std::ifstream ifs(fileName.c_str(), std::ios::in);
+        std::vector<std::pair<std::pair<int, int>, double>> edges;
+        int i, j, nbNodes = 0;
+        double value;
+        while (ifs >> i >> j >> value)
+        {
+            edges.emplace_back(std::make_pair(i, j), value);
+            nbNodes = std::max(nbNodes, std::max(i, j) + 1);
+        }
+        if (edges.empty())
+            return false;
+        xSolution.clear(nbNodes);
+        for (const auto & edge : edges)
+            xSolution.addEdge(edge.first.first, edge.first.second, edge.second);
+        xSolution.finalize();
+        return true;
+    }
+
+    // Wall time of a call (s)
+    template <typename Function>
+    double time(Function function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+#endif
@@ -0,0 +1,275 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+// Heap allocations and latency of the BaPCod-free steps of a UserBranchingFunctor call, counted by an overridden
+// global operator new: the sparse LP solution, the changed edges since the previous node (getChangedEdges), the
+// support sets of the cutset-like candidates (DisjointSets) with the terms of their constraints (Bitset), the
+// pending records of the pseudo-costs (PendingBranchings, matched against the new solution as in updatePseudoCosts)
+// and the min cut of --enableMinCut (SparseXSolution::toDense and MinimumCut). The steps that need BaPCod (reading
+// the primal solution and the reduced costs, building the constraints) are not covered.
+// The LP solutions are a sequence of nodes: a random convex combination of 3 random route sets, changed at each
+// following node by moving a customer between two routes of one route set. The sequence is run with the buffers
+// created at each call (as the functor did before keeping them) and with the buffers kept between calls; the
+// latter is first run over the sequence until a pass makes no allocation (the warm-ups, at most 10), and the next
+// pass must then make no allocation.
+// Built with -DCVRP_BUILD_BENCHMARKS=ON (CMake target BranchingAllocationsBenchmark), or from the application folder:
+//     g++ -std=c++14 -O2 -I include -I ../common/include benchmarks/BranchingAllocationsBenchmark.cpp src/SparseXSolution.cpp
+//         src/DisjointSets.cpp src/PendingBranchings.cpp
+// Usage: BranchingAllocationsBenchmark [<nb. of nodes> (100)]
+
+#include "BenchmarkUtils.h"
+#include "Bitset.h"
+#include "ClusterFlows.h"
+#include "DisjointSets.h"
+#include "PendingBranchings.h"
+#include "SparseXSolution.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+    long nbAllocations = 0;
+    bool countAllocations = false;
+}
+
+void * operator new(std::size_t size)
+{
+    if (countAllocations)
+        nbAllocations++;
+    if (void * pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+    using cvrp_joao::WeightedEdge;
+
+    // Buffers of a call, as kept by UserBranchingFunctor
+    struct Workspace
+    {
+        std::vector<WeightedEdge> lpEdges;
+        std::vector<WeightedEdge> previousEdges;
+        std::vector<WeightedEdge> changedEdges;
+        cvrp_joao::SparseXSolution xSolution;
+        ds::DisjointSets unionFind;
+        ds::Bitset members;
+        std::vector<std::pair<int, int>> terms;
+        std::vector<int> signatureArena;
+        std::vector<int> signatureBegin;
+        std::vector<std::vector<double>> xDense;
+        ds::MinimumCut minimumCut;
+    };
+
+    // Flow leaving the set of a signature (its first entry is a tag)
+    double getSignatureValue(const int * first, const int * last, const cvrp_joao::SparseXSolution & xSolution,
+                             ds::Bitset & members)
+    {
+        for (auto k = first + 1; k != last; ++k)
+            members.set(*k);
+        double value = 0.0;
+        for (int e = 0; e < xSolution.nbEdges(); e++)
+            if (members.test(xSolution.edgeFirstNode(e)) != members.test(xSolution.edgeSecondNode(e)))
+                value += xSolution.edgeLPValue(e);
+        for (auto k = first + 1; k != last; ++k)
+            members.reset(*k);
+        return value;
+    }
+
+    void branchingCall(Workspace & w, cvrp_joao::PendingBranchings & pendingBranchings,
+                       const std::vector<WeightedEdge> & lpSolution, int n, int nodeId, bool minCut)
+    {
+        const double epsilon = 1e-6;
+        w.lpEdges.assign(lpSolution.begin(), lpSolution.end());
+        w.xSolution.clear(n + 1);
+        for (const auto & edge : w.lpEdges)
+            w.xSolution.addEdge(edge.first.first, edge.first.second, edge.second);
+        w.xSolution.finalize();
+        cvrp_joao::getChangedEdges(w.previousEdges, w.lpEdges, 0.1 * w.lpEdges.size(), w.changedEdges);
+        w.previousEdges.assign(w.lpEdges.begin(), w.lpEdges.end());
+
+        /// Parent of the node among the pending records (UserBranchingFunctor::updatePseudoCosts)
+        w.members.resize(n + 1);
+        for (int k = pendingBranchings.size() - 1; k >= 0; k--)
+        {
+            auto & pending = pendingBranchings[k];
+            int match = -1, nbMatches = 0;
+            bool up = false;
+            for (int c = 0; c < pending.nbCandidates; c++)
+            {
+                auto value = getSignatureValue(pending.signatureBegin(c), pending.signatureEnd(c), w.xSolution,
+                                               w.members);
+                auto floorValue = std::floor(pending.values[c]);
+                if (value <= floorValue + epsilon || value >= floorValue + 1.0 - epsilon)
+                {
+                    match = c;
+                    up = value >= floorValue + 1.0 - epsilon;
+                    nbMatches++;
+                }
+            }
+            if (nbMatches != 1 || (up ? pending.upSeen : pending.downSeen))
+                continue;
+            pending.branched = match;
+            (up ? pending.upSeen : pending.downSeen) = true;
+            if (pending.upSeen && pending.downSeen)
+                pendingBranchings.erase(k);
+            break;
+        }
+
+        /// Cutset-like candidates: connected sets of customers with x_e >= 0.5
+        w.unionFind.reset(n);
+        for (int e = 0; e < w.xSolution.nbEdges(); e++)
+            if (w.xSolution.edgeFirstNode(e) > 0 && w.xSolution.edgeLPValue(e) >= 0.5)
+                w.unionFind.unionRank(w.xSolution.edgeFirstNode(e), w.xSolution.edgeSecondNode(e));
+        auto nbSets = w.unionFind.groupSets(n);
+        w.signatureArena.clear();
+        w.signatureBegin.clear();
+        for (int k = 0; k < nbSets; k++)
+        {
+            auto first = w.unionFind.setBegin(k), last = w.unionFind.setEnd(k);
+            if (last - first < 2 || last - first > 100)
+                continue;
+            w.signatureBegin.push_back((int) w.signatureArena.size());
+            w.signatureArena.push_back(-3);
+            w.signatureArena.insert(w.signatureArena.end(), first, last);
+        }
+        w.signatureBegin.push_back((int) w.signatureArena.size());
+
+        /// The kept candidates are recorded (UserBranchingFunctor::recordBranching)
+        /// with the terms of their constraints (UserBranchingFunctor::materializeCandidate)
+        auto & pending = pendingBranchings.next(nodeId, -1, 0.0);
+        for (int c = 0; c < std::min(10, (int) w.signatureBegin.size() - 1); c++)
+        {
+            auto first = w.signatureArena.data() + w.signatureBegin[c];
+            auto last = w.signatureArena.data() + w.signatureBegin[c + 1];
+            pending.addCandidate(first, last, getSignatureValue(first, last, w.xSolution, w.members),
+                                 std::make_pair(-1, -1), std::make_pair(-1, -1));
+            w.terms.clear();
+            for (auto i = first + 1; i != last; ++i)
+                w.members.set(*i);
+            for (auto i = first + 1; i != last; ++i)
+            {
+                for (int j = 1; j <= n; j++)
+                    if (!w.members.test(j))
+                        w.terms.emplace_back(std::min(*i, j), std::max(*i, j));
+                w.terms.emplace_back(0, *i);
+            }
+            for (auto i = first + 1; i != last; ++i)
+                w.members.reset(*i);
+        }
+        if (pending.nbCandidates > 0)
+            pendingBranchings.push();
+
+        if (minCut)
+        {
+            w.xSolution.toDense(w.xDense);
+            w.minimumCut.compute(w.xDense, n);
+        }
+    }
+
+    std::vector<std::vector<WeightedEdge>> nodeSequence(int n, int nbNodes)
+    {
+        std::mt19937 generator(n);
+        std::vector<std::vector<std::vector<int>>> solutions;
+        for (int s = 0; s < 3; s++)
+            solutions.push_back(bench::randomRoutes(n, generator));
+        std::vector<std::vector<WeightedEdge>> sequence;
+        cvrp_joao::SparseXSolution xSolution;
+        for (int node = 0; node < nbNodes; node++)
+        {
+            if (node > 0)
+            {
+                /// Moving a customer to another route of the same route set
+                auto & routes = solutions[std::uniform_int_distribution<int>(0, 2)(generator)];
+                std::uniform_int_distribution<int> route(0, (int) routes.size() - 1);
+                int r1 = route(generator), r2 = route(generator);
+                if (r1 != r2 && routes[r1].size() > 1)
+                {
+                    auto position = std::uniform_int_distribution<int>(0, (int) routes[r1].size() - 1)(generator);
+                    auto target = std::uniform_int_distribution<int>(0, (int) routes[r2].size())(generator);
+                    routes[r2].insert(routes[r2].begin() + target, routes[r1][position]);
+                    routes[r1].erase(routes[r1].begin() + position);
+                }
+            }
+            bench::routesToLPSolution(n, solutions, {0.5, 0.3, 0.2}, xSolution);
+            sequence.emplace_back();
+            for (int e = 0; e < xSolution.nbEdges(); e++)
+                sequence.back().emplace_back(std::make_pair(xSolution.edgeFirstNode(e), xSolution.edgeSecondNode(e)),
+                                             xSolution.edgeLPValue(e));
+        }
+        return sequence;
+    }
+
+    // Nb. of allocations and time (s) of the calls over the sequence
+    std::pair<long, double> run(const std::vector<std::vector<WeightedEdge>> & sequence, int n, bool minCut,
+                                bool keepBuffers, Workspace & workspace, cvrp_joao::PendingBranchings & pending)
+    {
+        nbAllocations = 0;
+        double time = 0.0;
+        for (int node = 0; node < (int) sequence.size(); node++)
+        {
+            countAllocations = true;
+            if (keepBuffers)
+                time += bench::time([&]() { branchingCall(workspace, pending, sequence[node], n, node, minCut); });
+            else
+                time += bench::time([&]() {
+                    Workspace callWorkspace;
+                    callWorkspace.previousEdges = workspace.previousEdges;
+                    branchingCall(callWorkspace, pending, sequence[node], n, node, minCut);
+                    workspace.previousEdges.swap(callWorkspace.previousEdges);
+                });
+            countAllocations = false;
+        }
+        return std::make_pair(nbAllocations, time);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int nbNodes = (argc > 1) ? std::atoi(argv[1]) : 100;
+    printf("%6s %7s %6s %13s %12s %9s %12s %12s %8s\n", "n", "minCut", "nodes", "fresh allocs", "fresh time",
+           "warm-ups", "kept allocs", "kept time", "speedup");
+    bool noAllocation = true;
+    for (const auto & n : {100, 200, 500, 1000, 2000})
+    {
+        auto sequence = nodeSequence(n, nbNodes);
+        for (bool minCut : {false, true})
+        {
+            /// The min cut is O(n^3)
+            if (minCut && n > 200)
+                continue;
+            Workspace freshWorkspace, keptWorkspace;
+            cvrp_joao::PendingBranchings freshPending, keptPending;
+            auto fresh = run(sequence, n, minCut, false, freshWorkspace, freshPending);
+            /// The buffers grow up to the largest sizes met, so the sequence is run until a pass does not allocate
+            int nbWarmUps = 1;
+            while (run(sequence, n, minCut, true, keptWorkspace, keptPending).first > 0 && nbWarmUps < 10)
+                nbWarmUps++;
+            auto kept = run(sequence, n, minCut, true, keptWorkspace, keptPending);
+            printf("%6d %7s %6d %13.1f %10.1fus %9d %12.1f %10.1fus %7.2fx\n", n, minCut ? "yes" : "no", nbNodes,
+                   (double) fresh.first / nbNodes, 1e6 * fresh.second / nbNodes, nbWarmUps,
+                   (double) kept.first / nbNodes, 1e6 * kept.second / nbNodes, fresh.second / kept.second);
+            noAllocation = noAllocation && (kept.first == 0);
+        }
+    }
+    if (!noAllocation)
+        fprintf(stderr, "Error: the calls with the kept buffers allocated after the warm-up\n");
+    return noAllocation ? 0 : 1;
+}
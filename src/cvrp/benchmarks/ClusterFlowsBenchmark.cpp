@@ -0,0 +1,332 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+// Comparison of the cluster branching candidates (DegCluster and AggClusters) given by the cluster flows of
+// ClusterFlows.h with those of the previous loops, which summed the flow of each cluster over the neighbors of its
+// vertices and the flow of each pair of disjoint clusters over |C_k| x |C_l|. For each cluster file (the files of
+// clusters/, as given by --clustersFilePath), a sequence of fractional LP solutions is generated: a random convex
+// combination of 3 random route sets, changed at each following node by moving a customer between two routes of
+// one route set. The candidates of each node are computed by the previous loops, by the single pass over the
+// positive edges (getClusterFlows), and by the incremental update of UserBranchingFunctor::updateAggregates
+// (getChangedEdges, addEdgeFlows and mergePairFlows); the three candidate lists must be the same, with the same
+// values up to the rounding of the sums.
+// Built with -DCVRP_BUILD_BENCHMARKS=ON (CMake target ClusterFlowsBenchmark), or from the application folder:
+//     g++ -std=c++14 -O2 -I include -I ../common/include benchmarks/ClusterFlowsBenchmark.cpp src/SparseXSolution.cpp
+// Usage: ClusterFlowsBenchmark [<clusters folder> (clusters)] [<nb. of nodes per file> (10)]
+
+#include "BenchmarkUtils.h"
+#include "Bitset.h"
+#include "ClusterFlows.h"
+#include "SparseXSolution.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Cluster family of a cluster file, with the members used by ClusterFlows.h (as cluster::Clustering)
+    struct FileClusters
+    {
+        int dimension = 0;
+        std::vector<std::pair<int, std::vector<int>>> clusters;
+        std::vector<std::vector<int>> vertexClusters;
+        std::vector<ds::Bitset> clusterCustomers;
+        std::vector<ds::Bitset> intersecting;
+
+        bool customerInCluster(int custId, int clustId) const { return clusterCustomers[clustId].test(custId); }
+        bool isDisjoint(int i, int j) const { return !intersecting[i].test(j); }
+
+        bool read(const std::string & fileName)
+        {
+            std::ifstream ifs(fileName.c_str(), std::ios::in);
+            std::string line;
+            while (std::getline(ifs, line) && line.find("CLUSTERS") == std::string::npos)
+                if (line.find("DIMENSION") != std::string::npos)
+                    dimension = std::atoi(line.c_str() + line.find(':') + 1);
+            auto cluId = 1;
+            while (std::getline(ifs, line) && line.compare(0, 3, "EOF") != 0)
+            {
+                std::istringstream ss(line);
+                std::vector<int> clusterNodes;
+                int node;
+                while (ss >> node)
+                    clusterNodes.push_back(node);
+                if (clusterNodes.size() < 2)
+                    continue;
+                clusterNodes.erase(clusterNodes.begin());
+                clusters.emplace_back(cluId++, clusterNodes);
+            }
+            if (dimension == 0 || clusters.empty())
+                return false;
+
+            auto nbClusters = (int) clusters.size();
+            clusterCustomers.assign(nbClusters + 1, ds::Bitset(dimension));
+            intersecting.assign(nbClusters + 1, ds::Bitset(nbClusters + 1));
+            vertexClusters.assign(dimension, std::vector<int>());
+            for (int k = 0; k < nbClusters; k++)
+                for (const auto & vertex : clusters[k].second)
+                {
+                    clusterCustomers[clusters[k].first].set(vertex);
+                    vertexClusters[vertex].push_back(k);
+                }
+            for (int k = 0; k < nbClusters; k++)
+                for (int l = k + 1; l < nbClusters; l++)
+                    if (clusterCustomers[clusters[k].first].intersects(clusterCustomers[clusters[l].first]))
+                    {
+                        intersecting[clusters[k].first].set(clusters[l].first);
+                        intersecting[clusters[l].first].set(clusters[k].first);
+                    }
+            return true;
+        }
+    };
+
+    // Candidate of the cluster branching: cluster positions (l = -1 for DegCluster) and value
+    struct Candidate
+    {
+        int k, l;
+        double value;
+    };
+
+    const double threshold = 0.1;
+
+    void addIfFractional(std::vector<Candidate> & candidates, int k, int l, double value)
+    {
+        double fractionalPart = value - (int) value;
+        if (fractionalPart > threshold && fractionalPart < 1 - threshold)
+            candidates.push_back({k, l, value});
+    }
+
+    // Previous loops of UserBranchingFunctor::branchingOverDefaultClusters
+    void oldCandidates(const cvrp_joao::SparseXSolution & xSolution, const FileClusters & family,
+                       std::vector<Candidate> & candidates)
+    {
+        candidates.clear();
+        for (int k = 0; k < (int) family.clusters.size(); k++)
+        {
+            const auto & cluster = family.clusters[k];
+            double totalXvalueDeg = 0;
+            for (const int & j : cluster.second)
+                for (int a = xSolution.adjBegin(j); a < xSolution.adjEnd(j); ++a)
+                    if (!family.customerInCluster(xSolution.adjNode(a), cluster.first))
+                        totalXvalueDeg += xSolution.adjValue(a);
+            addIfFractional(candidates, k, -1, totalXvalueDeg / 2.0);
+        }
+        for (int k = 0; k < (int) family.clusters.size(); k++)
+        {
+            auto firstClusterId = family.clusters[k].first;
+            for (int l = k + 1; l < (int) family.clusters.size(); l++)
+            {
+                auto secondClusterId = family.clusters[l].first;
+                if (!family.isDisjoint(firstClusterId, secondClusterId))
+                    continue;
+
+                double totalXvalueBtwClusters = 0;
+                for (const int & i : family.clusters[k].second)
+                    for (int a = xSolution.adjBegin(i); a < xSolution.adjEnd(i); ++a)
+                        if (family.customerInCluster(xSolution.adjNode(a), secondClusterId))
+                            totalXvalueBtwClusters += xSolution.adjValue(a);
+                addIfFractional(candidates, k, l, totalXvalueBtwClusters);
+            }
+        }
+    }
+
+    // Candidates from the cluster flows, as in UserBranchingFunctor::branchingOverDefaultClusters
+    void flowCandidates(const std::vector<double> & boundaryFlow, const std::vector<cvrp_joao::PairFlow> & pairFlows,
+                        std::vector<Candidate> & candidates)
+    {
+        candidates.clear();
+        auto nbClusters = (long long) boundaryFlow.size();
+        for (int k = 0; k < (int) nbClusters; k++)
+            addIfFractional(candidates, k, -1, boundaryFlow[k] / 2.0);
+        for (size_t p = 0; p < pairFlows.size(); )
+        {
+            auto key = pairFlows[p].first;
+            double totalXvalueBtwClusters = 0;
+            for (; p < pairFlows.size() && pairFlows[p].first == key; p++)
+                totalXvalueBtwClusters += pairFlows[p].second;
+            addIfFractional(candidates, (int) (key / nbClusters), (int) (key % nbClusters), totalXvalueBtwClusters);
+        }
+    }
+
+    // Incremental aggregates, as in UserBranchingFunctor::updateAggregates
+    struct Aggregates
+    {
+        bool valid = false;
+        int nbIncrementalUpdates = 0;
+        std::vector<cvrp_joao::WeightedEdge> aggregatedEdges, currentEdges, changedEdges;
+        std::vector<double> boundaryFlow;
+        std::vector<cvrp_joao::PairFlow> pairFlows, pairFlowChanges;
+
+        bool update(const cvrp_joao::SparseXSolution & xSolution, const FileClusters & family)
+        {
+            double maxChangedRatio = 0.25;
+            int maxIncrementalUpdates = 50;
+            currentEdges.clear();
+            for (int e = 0; e < xSolution.nbEdges(); e++)
+                currentEdges.emplace_back(std::make_pair(xSolution.edgeFirstNode(e), xSolution.edgeSecondNode(e)),
+                                          xSolution.edgeLPValue(e));
+            bool incremental = valid && nbIncrementalUpdates < maxIncrementalUpdates
+                               && cvrp_joao::getChangedEdges(aggregatedEdges, currentEdges,
+                                                             maxChangedRatio * currentEdges.size(), changedEdges);
+            if (!incremental)
+            {
+                changedEdges = currentEdges;
+                boundaryFlow.assign(family.clusters.size(), 0.0);
+                pairFlows.clear();
+                nbIncrementalUpdates = 0;
+            }
+            else
+                nbIncrementalUpdates++;
+
+            pairFlowChanges.clear();
+            for (const auto & edge : changedEdges)
+                cvrp_joao::addEdgeFlows(family, edge.first.first, edge.first.second, edge.second, boundaryFlow,
+                                        pairFlowChanges);
+            cvrp_joao::mergePairFlows(pairFlows, pairFlowChanges);
+            aggregatedEdges.swap(currentEdges);
+            valid = true;
+            return incremental;
+        }
+    };
+
+    // Max. difference of the values of two candidate lists, or -1 if the candidates are not the same
+    double compare(const std::vector<Candidate> & first, const std::vector<Candidate> & second)
+    {
+        if (first.size() != second.size())
+            return -1.0;
+        double maxDiff = 0.0;
+        for (size_t c = 0; c < first.size(); c++)
+        {
+            if (first[c].k != second[c].k || first[c].l != second[c].l)
+                return -1.0;
+            maxDiff = std::max(maxDiff, std::abs(first[c].value - second[c].value));
+        }
+        return maxDiff;
+    }
+
+    std::vector<std::string> clusterFiles(const std::string & folder)
+    {
+        std::vector<std::string> files;
+        if (auto dir = opendir(folder.c_str()))
+        {
+            while (auto entry = readdir(dir))
+            {
+                std::string name = entry->d_name;
+                if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+                    files.push_back(folder + "/" + name);
+            }
+            closedir(dir);
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string folder = (argc > 1) ? argv[1] : "clusters";
+    int nbNodes = (argc > 2) ? std::atoi(argv[2]) : 10;
+
+    auto files = clusterFiles(folder);
+    if (files.empty())
+    {
+        std::cerr << "Error: no cluster file in " << folder << std::endl;
+        return 1;
+    }
+
+    double oldTime = 0.0, fullTime = 0.0, incrementalTime = 0.0, maxDiff = 0.0;
+    long long nbCalls = 0, nbIncremental = 0, nbCandidates = 0, nbMismatches = 0;
+    int nbFiles = 0;
+    cvrp_joao::SparseXSolution xSolution;
+    std::vector<double> boundaryFlow;
+    std::vector<cvrp_joao::PairFlow> pairFlows;
+    std::vector<Candidate> previousCandidates, fullCandidates, incrementalCandidates;
+    for (size_t f = 0; f < files.size(); f++)
+    {
+        FileClusters family;
+        if (!family.read(files[f]))
+        {
+            std::cerr << "Error: cannot read the cluster file " << files[f] << std::endl;
+            return 1;
+        }
+        nbFiles++;
+
+        std::mt19937 generator((unsigned) f);
+        int nbCustomers = family.dimension - 1;
+        std::vector<std::vector<std::vector<int>>> solutions;
+        std::vector<double> weights;
+        std::uniform_real_distribution<double> weight(0.1, 1.0);
+        double totalWeight = 0.0;
+        for (int s = 0; s < 3; s++)
+        {
+            solutions.push_back(bench::randomRoutes(nbCustomers, generator));
+            weights.push_back(weight(generator));
+            totalWeight += weights.back();
+        }
+        for (auto & w : weights)
+            w /= totalWeight;
+
+        Aggregates aggregates;
+        for (int node = 0; node < nbNodes; node++)
+        {
+            if (node > 0)
+            {
+                /// Moving a customer to another route of the same route set
+                auto & routes = solutions[std::uniform_int_distribution<int>(0, 2)(generator)];
+                std::uniform_int_distribution<int> route(0, (int) routes.size() - 1);
+                int r1 = route(generator), r2 = route(generator);
+                if (r1 != r2 && routes[r1].size() > 1)
+                {
+                    auto position = std::uniform_int_distribution<int>(0, (int) routes[r1].size() - 1)(generator);
+                    auto target = std::uniform_int_distribution<int>(0, (int) routes[r2].size())(generator);
+                    routes[r2].insert(routes[r2].begin() + target, routes[r1][position]);
+                    routes[r1].erase(routes[r1].begin() + position);
+                }
+            }
+            bench::routesToLPSolution(nbCustomers, solutions, weights, xSolution);
+
+            oldTime += bench::time([&]() { oldCandidates(xSolution, family, previousCandidates); });
+            fullTime += bench::time([&]() {
+                cvrp_joao::getClusterFlows(xSolution, family, boundaryFlow, pairFlows);
+                flowCandidates(boundaryFlow, pairFlows, fullCandidates);
+            });
+            incrementalTime += bench::time([&]() {
+                nbIncremental += aggregates.update(xSolution, family);
+                flowCandidates(aggregates.boundaryFlow, aggregates.pairFlows, incrementalCandidates);
+            });
+
+            nbCalls++;
+            nbCandidates += (long long) previousCandidates.size();
+            for (const auto & candidates : {fullCandidates, incrementalCandidates})
+            {
+                auto diff = compare(previousCandidates, candidates);
+                if (diff < 0 || diff > 1e-9)
+                    nbMismatches++;
+                else
+                    maxDiff = std::max(maxDiff, diff);
+            }
+        }
+    }
+
+    printf("Cluster files: %d, LP solutions: %lld (%lld incremental updates), candidates: %lld\n", nbFiles, nbCalls,
+           nbIncremental, nbCandidates);
+    printf("%-28s %12s %14s\n", "", "total time", "time per call");
+    printf("%-28s %11.4fs %12.2fus\n", "previous loops", oldTime, 1e6 * oldTime / nbCalls);
+    printf("%-28s %11.4fs %12.2fus\n", "single pass (full)", fullTime, 1e6 * fullTime / nbCalls);
+    printf("%-28s %11.4fs %12.2fus\n", "single pass (incremental)", incrementalTime, 1e6 * incrementalTime / nbCalls);
+    printf("Candidate lists different from the previous loops: %lld, max. value difference: %.3g\n", nbMismatches,
+           maxDiff);
+    return (nbMismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+// Micro-benchmark of the construction of the cutset branching constraints (UserBranchingFunctor::
+// materializeCandidate): the terms of delta(S) are listed with the previous membership test, a std::find over S for
+// every pair (i, j), and with the bitset of the functor. The sets S are built as the cutsets of CVRPSEP, which needs
+// the separation library: connected sets of customers with a fractional boundary, here the connected components of
+// the support graph restricted to the customers and to the edges with x_e >= 0.3, 0.5 or 0.7 (sets of 2 to 100
+// customers). The LP solutions are the root fractional solutions given as arguments (see --rootFracSolutionFilePath),
+// or, without arguments, random convex combinations of 3 random route sets of 100 to 5000 customers. Both versions
+// must give the same terms, in the same order.
+// Built with -DCVRP_BUILD_BENCHMARKS=ON (CMake target CutsetsBenchmark), or from the application folder:
+//     g++ -std=c++14 -O2 -I include -I ../common/include benchmarks/CutsetsBenchmark.cpp src/SparseXSolution.cpp src/DisjointSets.cpp
+// Usage: CutsetsBenchmark [<root fractional solution files>]
+
+#include "BenchmarkUtils.h"
+#include "Bitset.h"
+#include "DisjointSets.h"
+#include "SparseXSolution.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+    typedef std::vector<std::pair<int, int>> Terms;
+
+    // Cutset-like sets of a LP solution over the customers 1..n
+    std::vector<std::vector<int>> supportSets(const cvrp_joao::SparseXSolution & xSolution, int n)
+    {
+        std::vector<std::vector<int>> sets;
+        ds::DisjointSets unionFind;
+        for (const auto & minValue : {0.3, 0.5, 0.7})
+        {
+            unionFind.reset(n);
+            for (int e = 0; e < xSolution.nbEdges(); e++)
+                if (xSolution.edgeFirstNode(e) > 0 && xSolution.edgeLPValue(e) >= minValue)
+                    unionFind.unionRank(xSolution.edgeFirstNode(e), xSolution.edgeSecondNode(e));
+            auto nbSets = unionFind.groupSets(n);
+            for (int k = 0; k < nbSets; k++)
+            {
+                auto size = unionFind.setEnd(k) - unionFind.setBegin(k);
+                if (size >= 2 && size <= 100)
+                    sets.emplace_back(unionFind.setBegin(k), unionFind.setEnd(k));
+            }
+        }
+        return sets;
+    }
+
+    // Previous construction: the depot is n + 1, as in CVRPSEP
+    void previousTerms(const std::vector<int> & set, int n, Terms & terms)
+    {
+        for (const int & i: set) {
+            for (int j = 1; j <= n + 1; j++) {
+                if (std::find(set.begin(), set.end(), j) == set.end()) {
+                    int firstNodeId, secondNodeId;
+                    if ((i == n + 1) || (j == n + 1)) {
+                        firstNodeId = 0;
+                        secondNodeId = std::min(i, j);
+                    } else {
+                        firstNodeId = std::min(i, j);
+                        secondNodeId = std::max(i, j);
+                    }
+                    terms.emplace_back(firstNodeId, secondNodeId);
+                }
+            }
+        }
+    }
+
+    // Current construction (UserBranchingFunctor::materializeCandidate)
+    void bitsetTerms(const std::vector<int> & set, int n, ds::Bitset & members, Terms & terms)
+    {
+        for (const int & i: set)
+            members.set(i);
+        for (const int & i: set) {
+            for (int j = 1; j <= n; j++)
+                if (!members.test(j))
+                    terms.emplace_back(std::min(i, j), std::max(i, j));
+            terms.emplace_back(0, i);
+        }
+        for (const int & i: set)
+            members.reset(i);
+    }
+
+    bool run(const std::string & name, const cvrp_joao::SparseXSolution & xSolution)
+    {
+        int n = xSolution.nbNodes() - 1;
+        auto sets = supportSets(xSolution, n);
+        Terms previous, current;
+        ds::Bitset members(n + 1);
+        previous.reserve(101 * (n + 1));
+        current.reserve(101 * (n + 1));
+
+        double previousTime = 0.0, bitsetTime = 0.0, meanSize = 0.0;
+        bool same = true;
+        for (const auto & set : sets)
+        {
+            previous.clear();
+            current.clear();
+            previousTime += bench::time([&]() { previousTerms(set, n, previous); });
+            bitsetTime += bench::time([&]() { bitsetTerms(set, n, members, current); });
+            same = same && (previous == current);
+            meanSize += (double) set.size() / sets.size();
+        }
+        printf("%-32s %6d %6d %8.1f %11.4fms %11.4fms %8.1fx %5s\n", name.c_str(), n, (int) sets.size(), meanSize,
+               1e3 * previousTime, 1e3 * bitsetTime, previousTime / bitsetTime, same ? "yes" : "NO");
+        return same;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    printf("%-32s %6s %6s %8s %13s %13s %9s %5s\n", "solution", "n", "sets", "mean|S|", "std::find", "bitset",
+           "speedup", "same");
+    bool allSame = true;
+    cvrp_joao::SparseXSolution xSolution;
+    if (argc > 1)
+    {
+        for (int a = 1; a < argc; a++)
+        {
+            if (!bench::readRootFracSolution(argv[a], xSolution))
+            {
+                fprintf(stderr, "Error: cannot read the root fractional solution %s\n", argv[a]);
+                return 1;
+            }
+            allSame = run(argv[a], xSolution) && allSame;
+        }
+    }
+    else
+    {
+        for (const auto & n : {100, 200, 500, 1000, 2000, 5000})
+        {
+            std::mt19937 generator(n);
+            std::vector<std::vector<std::vector<int>>> solutions;
+            for (int s = 0; s < 3; s++)
+                solutions.push_back(bench::randomRoutes(n, generator));
+            bench::routesToLPSolution(n, solutions, {0.5, 0.3, 0.2}, xSolution);
+            allSame = run("random-" + std::to_string(n), xSolution) && allSame;
+        }
+    }
+    return allSame ? 0 : 1;
+}
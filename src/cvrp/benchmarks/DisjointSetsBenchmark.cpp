@@ -0,0 +1,156 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+// Benchmark of ds::DisjointSets against the previous union-find (raw arrays, recursive find, and grouping of the
+// sets by a double loop over the elements, in O(n^2)). The unions follow the use in FractionalClustering: the
+// elements are split in random paths of 2 to 20 elements (as the routes of a LP solution), and the elements of each
+// path are joined. Each round resets the union-find, joins the paths and groups the sets; the new union-find is
+// reused between rounds, as in FractionalClustering, and the sets of both versions are checked to be equal.
+// Built with -DCVRP_BUILD_BENCHMARKS=ON (CMake target DisjointSetsBenchmark), or from the application folder:
+//     g++ -std=c++14 -O2 -I include -I ../common/include benchmarks/DisjointSetsBenchmark.cpp src/DisjointSets.cpp
+// Usage: DisjointSetsBenchmark [<nb. of rounds per size> (10)]
+
+#include "BenchmarkUtils.h"
+#include "DisjointSets.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Previous version of ds::DisjointSets
+    class OldDisjointSets
+    {
+    public:
+        explicit OldDisjointSets(int n) : parent(new int[n + 1]), rank(new int[n + 1]), sets()
+        {
+            for (int i = 1; i < n + 1; i++)
+            {
+                parent[i] = -1;
+                rank[i] = 1;
+            }
+        }
+        ~OldDisjointSets()
+        {
+            delete[] parent;
+            delete[] rank;
+        }
+
+        int findParent(int i)
+        {
+            if (parent[i] == -1)
+                return i;
+            return parent[i] = findParent(parent[i]);
+        }
+
+        void unionRank(int x, int y)
+        {
+            int parX = findParent(x);
+            int parY = findParent(y);
+            if (parX == parY)
+                return;
+            if (rank[parX] < rank[parY])
+                parent[parX] = parY;
+            else if (rank[parX] > rank[parY])
+                parent[parY] = parX;
+            else
+            {
+                parent[parY] = parX;
+                rank[parX] += 1;
+            }
+        }
+
+        std::vector<std::vector<int>> getDisjointSets(int n)
+        {
+            sets.clear();
+            std::vector<bool> inSet(n + 1, false);
+            for (int firstVertex = 1; firstVertex <= n; firstVertex++)
+            {
+                if (inSet[firstVertex])
+                    continue;
+                std::vector<int> setAux;
+                setAux.push_back(firstVertex);
+                inSet[firstVertex] = true;
+                for (int secondVertex = firstVertex + 1; secondVertex <= n; secondVertex++)
+                    if (findParent(firstVertex) == findParent(secondVertex))
+                    {
+                        setAux.push_back(secondVertex);
+                        inSet[secondVertex] = true;
+                    }
+                sets.push_back(setAux);
+            }
+            return sets;
+        }
+
+    private:
+        int * parent;
+        int * rank;
+        std::vector<std::vector<int>> sets;
+    };
+
+    // Unions of random paths of 2 to 20 elements over 1..n
+    std::vector<std::pair<int, int>> randomPaths(int n, unsigned seed)
+    {
+        std::mt19937 generator(seed);
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 1);
+        std::shuffle(order.begin(), order.end(), generator);
+        std::uniform_int_distribution<int> pathSize(2, 20);
+        std::vector<std::pair<int, int>> unions;
+        for (int k = 0; k < n; )
+        {
+            int end = std::min(n, k + pathSize(generator));
+            for (int l = k + 1; l < end; l++)
+                unions.emplace_back(order[l - 1], order[l]);
+            k = end;
+        }
+        return unions;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int nbRounds = (argc > 1) ? std::atoi(argv[1]) : 10;
+    const int sizes[] = {100, 1000, 2000, 5000, 10000};
+
+    printf("%8s %8s %12s %12s %9s %9s\n", "n", "nbSets", "oldTime", "newTime", "speedup", "sameSets");
+    bool allSame = true;
+    for (const auto & n : sizes)
+    {
+        double oldTime = 0.0, newTime = 0.0;
+        int nbSets = 0;
+        bool same = true;
+        ds::DisjointSets unionFind;
+        for (int round = 0; round < nbRounds; round++)
+        {
+            auto unions = randomPaths(n, 1000 * n + round);
+            std::vector<std::vector<int>> oldSets, newSets;
+            oldTime += bench::time([&]() {
+                OldDisjointSets oldUnionFind(n);
+                for (const auto & pair : unions)
+                    oldUnionFind.unionRank(pair.first, pair.second);
+                oldSets = oldUnionFind.getDisjointSets(n);
+            });
+            newTime += bench::time([&]() {
+                unionFind.reset(n);
+                for (const auto & pair : unions)
+                    unionFind.unionRank(pair.first, pair.second);
+                nbSets = unionFind.groupSets(n);
+            });
+            for (int k = 0; k < nbSets; k++)
+                newSets.emplace_back(unionFind.setBegin(k), unionFind.setEnd(k));
+            same = same && (oldSets == newSets);
+        }
+        printf("%8d %8d %11.6fs %11.6fs %8.1fx %9s\n", n, nbSets, oldTime / nbRounds, newTime / nbRounds,
+               oldTime / newTime, same ? "yes" : "NO");
+        allSame = allSame && same;
+    }
+    return allSame ? 0 : 1;
+}
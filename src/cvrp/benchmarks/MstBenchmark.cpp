@@ -0,0 +1,86 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+// Scaling benchmark of the MST of the MST-based clustering (MSTClustering::kruskalMST): Kruskal over the complete
+// graph (n(n-1)/2 edges) against Kruskal over the sparse candidate graph of --enableSparseMST (Boruvka over a 2-d
+// tree). The instances are random (see BenchmarkUtils.h), and for each one the sorted MST weights of both graphs are
+// checked to be equal, so the clusters obtained by any cutoff are the same. The complete graph needs O(n^2) memory,
+// so it is skipped above a max. nb. of customers.
+// Built with -DCVRP_BUILD_BENCHMARKS=ON (CMake target MstBenchmark), or from the application folder:
+//     g++ -std=c++14 -O2 -I include -I ../common/include benchmarks/MstBenchmark.cpp src/DisjointSets.cpp
+// Usage: MstBenchmark [<max. nb. of customers of the complete graph> (10000)] [<nb. of instances per size> (3)]
+
+#include "BenchmarkUtils.h"
+#include "DisjointSets.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    // Same steps as MSTClustering::kruskalMST; returns the sorted weights of the MST edges
+    std::vector<double> kruskalMST(ds::Graph & graph)
+    {
+        std::vector<double> weights;
+        ds::DisjointSets sets(graph.n);
+        std::sort(graph.edges.begin(), graph.edges.end(), ds::Utils::sortByWeight);
+        for (const auto & edge : graph.edges)
+            if (sets.findParent(edge.first.first) != sets.findParent(edge.first.second))
+            {
+                sets.unionRank(edge.first.first, edge.first.second);
+                weights.push_back(edge.second);
+            }
+        return weights;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int maxCompleteSize = (argc > 1) ? std::atoi(argv[1]) : 10000;
+    int nbInstances = (argc > 2) ? std::atoi(argv[2]) : 3;
+    const int sizes[] = {100, 200, 500, 1000, 2000, 5000, 10000, 20000};
+
+    printf("%8s %12s %12s %12s %12s %9s %10s\n", "n", "completeEdges", "completeTime", "sparseEdges", "sparseTime",
+           "speedup", "sameMST");
+    bool allSame = true;
+    for (const auto & n : sizes)
+    {
+        bool complete = (n <= maxCompleteSize);
+        double completeTime = 0.0, sparseTime = 0.0;
+        long completeEdges = 0, sparseEdges = 0;
+        bool same = true;
+        for (int k = 0; k < nbInstances; k++)
+        {
+            const auto & data = bench::randomInstance(n, 1000 * n + k);
+            std::vector<double> sparseWeights, completeWeights;
+            sparseTime += bench::time([&]() {
+                ds::Graph graph(&data, true);
+                sparseEdges += (long) graph.edges.size();
+                sparseWeights = kruskalMST(graph);
+            });
+            if (!complete)
+                continue;
+            completeTime += bench::time([&]() {
+                ds::Graph graph(&data, false);
+                completeEdges += (long) graph.edges.size();
+                completeWeights = kruskalMST(graph);
+            });
+            same = same && (sparseWeights == completeWeights);
+        }
+
+        if (complete)
+            printf("%8d %12ld %11.4fs %12ld %11.4fs %8.1fx %10s\n", n, completeEdges / nbInstances,
+                   completeTime / nbInstances, sparseEdges / nbInstances, sparseTime / nbInstances,
+                   completeTime / sparseTime, same ? "yes" : "NO");
+        else
+            printf("%8d %12s %12s %12ld %11.4fs %9s %10s\n", n, "-", "-", sparseEdges / nbInstances,
+                   sparseTime / nbInstances, "-", "-");
+        allSame = allSame && same;
+    }
+    return allSame ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef DS_BITSET_H
+#define DS_BITSET_H
+
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ds
+{
+    // Fixed size set of bits packed in 64-bit words, used for cluster membership (one bit per vertex) and for the
+    // cluster intersection matrix (one bit per cluster). Bits beyond size() are always zero
+    class Bitset
+    {
+    public:
+        explicit Bitset(int nbBits_ = 0) : nbBits(nbBits_), words((nbBits_ + 63) / 64, 0) {}
+
+        int size() const { return nbBits; }
+        void resize(int nbBits_)
+        {
+            nbBits = nbBits_;
+            words.resize((nbBits_ + 63) / 64, 0);
+            /// When the set shrinks, the bits of the last word beyond the new size are cleared
+            if (nbBits & 63)
+                words.back() &= ((uint64_t) 1 << (nbBits & 63)) - 1;
+        }
+
+        bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+        void set(int i) { words[i >> 6] |= (uint64_t) 1 << (i & 63); }
+        void reset(int i) { words[i >> 6] &= ~((uint64_t) 1 << (i & 63)); }
+        void clear() { words.assign(words.size(), 0); }
+
+        int count() const
+        {
+            int total = 0;
+            for (const auto & word : words)
+                total += (int) std::bitset<64>(word).count();
+            return total;
+        }
+
+        // Both sets must have the same size
+        bool intersects(const Bitset & other) const
+        {
+            auto nbWords = (int) words.size();
+            int w = 0;
+#if defined(__AVX2__)
+            for (; w + 4 <= nbWords; w += 4)
+            {
+                auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words.data() + w));
+                auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(other.words.data() + w));
+                if (!_mm256_testz_si256(a, b))
+                    return true;
+            }
+#endif
+            for (; w < nbWords; w++)
+                if (words[w] & other.words[w])
+                    return true;
+            return false;
+        }
+
+        bool operator==(const Bitset & other) const { return nbBits == other.nbBits && words == other.words; }
+
+    private:
+        int nbBits;
+        std::vector<uint64_t> words;
+    };
+}
+
+#endif
@@ -13,13 +13,48 @@
 #include "Cutsets.h"
 #include "FractionalClustering.h"
 #include "BranchingFeatures.h"
+#include "SparseXSolution.h"
+#include "ClusterEdgeStore.h"
+#include "ClusterFlows.h"
+#include "ClusterRegistry.h"
+#include "PseudoCosts.h"
+#include "PendingBranchings.h"
+#include "Bitset.h"
 
 #include "bcModelBranchingConstrC.hpp"
+#include <cstdint>
 #include <random>
 #include <utility>
 
 namespace cvrp_joao
 {
+    enum class BranchingFamily
+    {
+        DefaultCluster,
+        RouteCluster,
+        FractionalCluster,
+        Cutset,
+        CostlyEdge
+    };
+
+    // Cheap descriptor of a branching candidate; its constraint is only built if the candidate is selected
+    struct BranchingCandidate
+    {
+        BranchingFamily family;
+        int first; // cluster/cutset id, or first node of the edge
+        int second; // second cluster id (-1 for degree branchings), or second node of the edge
+        std::pair<int, int> positions; // positions of the cluster(s) in their family (-1 if none)
+        const std::vector<int> * set; // customers of the cutset
+        int signatureBegin; // range of its signature in the signature buffer of the current node
+        int signatureEnd;
+        double value; // LP value of the constraint
+        double fractionalPart;
+        double cost; // edge cost
+        double score;
+        bool reliable; // if it has a reliable pseudo-cost
+        int order;
+    };
+
 	class UserBranchingFunctor : public BcDisjunctiveBranchingConstrSeparationFunctor
 	{
 		const Data & data;
@@ -28,13 +63,68 @@ namespace cvrp_joao
         fracclu::FractionalClustering & fractionalClusters;
         BranchingFeatures & branchingFeatures;
         int constrCount;
-        std::unordered_map<std::string, size_t> cutsetsIdMap;
+        Cutsets cutsets;
+        std::vector<int> cutsetEdgeTail;
+        std::vector<int> cutsetEdgeHead;
+        std::vector<double> cutsetEdgeLPValue;
+        ds::Bitset cutsetMembers;
+        ClusterEdgeStore defaultClusterEdges;
+        ClusterEdgeStore fracClusterEdges;
+        std::vector<BranchingCandidate> candidates; // candidates of all families at the current node
+        std::vector<int> signatureArena; // signatures of the candidates at the current node
+        std::vector<std::pair<uint64_t, int>> signatureHashes;
+        std::vector<char> isDuplicate;
+        std::vector<int> signatureScratch;
+        std::vector<double> duplicateScores;
+        long nbSavedSBEvaluations;
+        PseudoCosts & pseudoCosts;
+        PendingBranchings pendingBranchings; // last nodes whose children were not all seen yet
+        std::vector<char> signatureSide; // 1 for the first set of a signature, 2 for the second one, 0 otherwise
+        /// Positive edges of the current and of the last primal solution whose candidates are kept in 'candidates'
+        std::vector<std::pair<std::pair<int, int>, double>> lpEdges;
+        std::vector<std::pair<std::pair<int, int>, double>> cachedLpEdges;
+        uint64_t cachedFingerprint;
+        int cachedListMaxSize;
+        bool cacheValid;
+        /// Aggregates of the default and route clusters for the last solution, whose sorted edges are kept
+        std::vector<std::pair<std::pair<int, int>, double>> aggregatedEdges;
+        std::vector<double> clusterBoundaryFlow;
+        std::vector<std::pair<long long, double>> clusterPairFlows; // sorted by key, without null flows
+        std::vector<double> routeDegree;
+        std::vector<int> routeClusterIds;
+        std::vector<std::vector<int>> vertexRoutes; // positions of the route clusters containing each vertex
+        bool aggregatesValid;
+        int nbIncrementalUpdates;
+        int nodeId; // sequence number of the calls that generated candidates
+        int nodeDepth; // -1 if unknown
+        std::vector<double> familyScores; // scores of the edge candidates, reassigned by cost
+        std::vector<int> scorerPositions; // positions of the edge candidates given to the learned scorer
+        std::vector<std::pair<int, int>> scorerEdges;
+        std::vector<double> scorerScores;
+        std::vector<double> scorerHeuristicScores;
+        std::vector<int> scorerOrder;
+        /// Buffers of the hot path, kept between calls so that they are only allocated while they grow
+        SparseXSolution lpSolution;
+        std::vector<std::pair<std::pair<int, int>, double>> aggregateEdgesAux;
+        std::vector<std::pair<std::pair<int, int>, double>> changedEdges;
+        std::vector<std::pair<long long, double>> pairFlowChanges;
+        std::vector<double> fracBoundaryFlow;
+        std::vector<std::pair<long long, double>> fracPairFlows;
+        std::vector<std::vector<double>> xReducedCosts;
+        std::vector<std::vector<int>> xNbColumns;
+        std::vector<std::vector<int>> xColumnStamp;
+        std::vector<std::pair<int, int>> xReducedCostEntries; // entries written in xReducedCosts, zeroed by the next call
+        std::vector<std::pair<int, int>> xNbColumnEntries;
+        int xNbStampedColumns; // columns counted by all calls, so that xColumnStamp is never reset
+        std::vector<std::vector<double>> xDenseSolution;
+        ds::MinimumCut minimumCut;
 
 	public:
         UserBranchingFunctor(const Data & data_, const Parameters & params_,
                              const cluster::Clustering & clusters_,
                              fracclu::FractionalClustering & fractionalClusters_,
-                             BranchingFeatures & branchingFeatures_);
+                             BranchingFeatures & branchingFeatures_,
+                             PseudoCosts & pseudoCosts_);
 
 		~UserBranchingFunctor() override;
 
@@ -43,38 +133,45 @@ namespace cvrp_joao
                                  const int & candListMaxSize,
                                  std::list<std::pair<BcConstr, std::string> > & returnBrConstrList) override;
 
+        static void printCacheStatistics();
+
     private:
-        static bool sortRule(const std::pair<int, double> a, const std::pair<int, double> & b)
-        {
-            return std::abs(0.5 - a.second) < std::abs(0.5 - b.second);
-        };
-
-        static bool costSort(const std::pair<std::pair<int,int>, double> a, const std::pair<std::pair<int,int>, double> & b)
-        {
-            return a.second > b.second;
-        };
-
-        std::vector<std::vector<double>> getReducedCosts(const BcFormulation & spForm) const;
-        std::vector<std::vector<int>> getVarNbColumns(const std::list<std::pair<double, BcSolution>> & columnsInSol) const;
-
-        bool branchingOverDefaultClusters(BcBranchingConstrArray & userBranching, BcVarArray & xVar,
-                                         const std::vector<std::vector<double> > & xSolution,
-                                         std::list<std::pair<BcConstr, std::string> > & returnBrConstrList);
-        bool branchingOverFractionalClusters(BcBranchingConstrArray & userBranching, BcVarArray & xVar,
-                                          const std::vector<std::vector<double> > & xSolution,
-                                          std::list<std::pair<BcConstr, std::string> > & returnBrConstrList);
-        bool branchingOverRouteClusters(BcBranchingConstrArray & userBranching, BcVarArray & xVar,
-                                       const std::vector<std::vector<double> > & xSolution,
-                                       std::list<std::pair<BcConstr, std::string> > & returnBrConstrList);
-        bool branchingOverCostlyEdges(BcBranchingConstrArray & userBranching, BcVarArray & xVar,
-                                      const std::vector<std::vector<double> > & xSolution,
-                                      std::list<std::pair<BcConstr, std::string> > & returnBrConstrList,
-                                      const int & candListMaxSize);
-        bool branchingOverCutsets(BcBranchingConstrArray & userBranching, BcVarArray & xVar,
-                                          const std::vector<std::vector<double> > & xSolution,
-                                          std::list<std::pair<BcConstr, std::string> > & returnBrConstrList);
-
-        bool computeMinCut(BcVarArray & xVar, const std::vector<std::vector<double> > & xSolution);
+        /// Tags of the candidate signatures (negative, so they come before the vertices)
+        enum SignatureTag { DegreeTag = -3, RouteDegreeTag = -2, AggregatedTag = -1 };
+
+        void updateReducedCosts(const BcFormulation & spForm);
+        void updateVarNbColumns(const std::list<std::pair<double, BcSolution>> & columnsInSol);
+
+        void addEdgeRouteDegrees(int i, int j, double value);
+        void updateAggregates(const SparseXSolution & xSolution);
+
+        void branchingOverDefaultClusters();
+        void branchingOverFractionalClusters(const SparseXSolution & xSolution);
+        void branchingOverRouteClusters();
+        void branchingOverCostlyEdges(const SparseXSolution & xSolution);
+        void branchingOverCutsets(const SparseXSolution & xSolution);
+
+        BranchingCandidate & addCandidate(BranchingFamily family, int first, int second, double value);
+        double familyPriority(BranchingFamily family) const;
+        void addCandidateSignature(const BranchingCandidate & candidate, std::vector<int> & signature);
+        const std::vector<int> & getCandidateSignature(const BranchingCandidate & candidate);
+        const std::vector<int> & getPendingSignature(const PendingBranching & pending, int c);
+        void removeDuplicateCandidates();
+        void applyBranchingScorer();
+        void selectCandidates(const int & candListMaxSize);
+        double getSignatureValue(const std::vector<int> & signature, const SparseXSolution & xSolution);
+        void updatePseudoCosts(double lpValue, const SparseXSolution & xSolution);
+        void recordBranching(double lpValue);
+        void materializeCandidate(const BranchingCandidate & candidate, BcBranchingConstrArray & userBranching,
+                                  BcVarArray & xVar, std::list<std::pair<BcConstr, std::string> > & returnBrConstrList);
+
+        bool computeMinCut(BcVarArray & xVar, const SparseXSolution & xSolution);
+
+        static uint64_t getFingerprint(const std::vector<std::pair<std::pair<int, int>, double>> & edges);
+
+        static long nbCacheHits;
+        static long nbCacheMisses;
+        static double cacheMissTime; // time of the calls that generated the candidates (s)
 
         static bool rootProcessed;
         static void saveRootFracSolution(std::set<BcVar> & xVarSet, const std::string & instaceName, const std::string & filePath);
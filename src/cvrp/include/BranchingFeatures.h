@@ -11,44 +11,62 @@
 #include "Parameters.h"
 #include "Clustering.h"
 #include "FractionalClustering.h"
+#include "SparseXSolution.h"
+#include "FeatureLog.h"
+#include "BranchingScorer.h"
 
 #include "Singleton.h"
 
 #include <iostream>
-#include <map>
-#include <stack>
+#include <cstdint>
+#include <algorithm>
 
 namespace cvrp_joao
 {
-    class EdgeFeatures
+    // Features of the edges, stored by column (row r of every array is the r-th inserted edge). The rows are found
+    // through an open-addressing hash table (linear probing) keyed by the packed edge id
+    class EdgeFeatureStore
     {
     public:
-        EdgeFeatures(double fracValue = 0.0, double avgFracValue = 0.0, double cost = 0.0, double reducedCost = 0.0,
-                  double distDepot = 0.0, double distConvexHull = 0.0, double distNearestNeighbor = 0.0,
-                  double sumDemandsEndpoints = 0.0, double sumDemandsNeighbors = 0.0, int nbBranchingOn = 0,
-                  int nbRoutesIn = 0, int nbSBEval = 0) :
-                  fracValue(fracValue), avgFracValue(avgFracValue), cost(cost), reducedCost(reducedCost),
-                  distDepot(distDepot), distConvexHull(distConvexHull), distNearestNeighbor(distNearestNeighbor),
-                  sumDemandsEndpoints(sumDemandsEndpoints), nbSBEval(nbSBEval),
-                  sumDemandsNeighbors(sumDemandsNeighbors), nbBranchingOn(nbBranchingOn), nbRoutesIn(nbRoutesIn)
-        {}
-
-        double fracValue;
-        double avgFracValue;
-        double cost;
-        double reducedCost;
-        double distDepot;
-        double distConvexHull;
-        double distNearestNeighbor;
-        double sumDemandsEndpoints;
-        double sumDemandsNeighbors; // endpoints + neighbors
-        int nbBranchingOn;
-        int nbRoutesIn;
-        int nbSBEval;
+        EdgeFeatureStore() : edgeIds(), fracValue(), avgFracValue(), cost(), reducedCost(), distDepot(),
+                             distConvexHull(), distNearestNeighbor(), sumDemandsEndpoints(), sumDemandsNeighbors(),
+                             nbBranchingOn(), nbRoutesIn(), nbSBEval(), lastEvalNode(), slots(), mask(0) {}
+
+        static uint64_t edgeId(int i, int j) { return ((uint64_t) (uint32_t) i << 32) | (uint32_t) j; }
+        static int firstNode(uint64_t id) { return (int) (id >> 32); }
+        static int secondNode(uint64_t id) { return (int) (uint32_t) id; }
+
+        int size() const { return (int) edgeIds.size(); }
+        // Row of the edge, or -1
+        int find(uint64_t id) const;
+        // Row of the edge and true if it was added (with null features)
+        std::pair<int, bool> insert(uint64_t id);
+
+        std::vector<uint64_t> edgeIds;
+        std::vector<double> fracValue;
+        std::vector<double> avgFracValue;
+        std::vector<double> cost;
+        std::vector<double> reducedCost;
+        std::vector<double> distDepot;
+        std::vector<double> distConvexHull;
+        std::vector<double> distNearestNeighbor;
+        std::vector<double> sumDemandsEndpoints;
+        std::vector<double> sumDemandsNeighbors; // endpoints + neighbors
+        std::vector<int> nbBranchingOn;
+        std::vector<int> nbRoutesIn;
+        std::vector<int> nbSBEval;
+        std::vector<int> lastEvalNode; // node of the last evaluation, -1 if none (not logged)
+
+    private:
+        std::vector<int> slots; // row + 1, 0 if the slot is empty
+        uint64_t mask;
+
+        static uint64_t hash(uint64_t id);
+        void grow();
     };
 
-    // Find the convex hull of a set of points using Graham Scan algorithm
-    // Code based on https://github.com/kartikkukreja/blog-codes/blob/master/src/Graham%20Scan%20Convex%20Hull.cpp
+    // Convex hull of the depot and the customers using Andrew's monotone chain algorithm, in counter-clockwise
+    // order and without collinear points
     class ConvexHull
     {
     public:
@@ -59,88 +77,12 @@ namespace cvrp_joao
             getConvexHull(data);
         };
 
-        static double distancePointToLine(double px1, double py1, double lx1, double ly1, double lx2, double ly2)
-        {
-            auto num = std::abs((lx2-lx1) * (ly1-py1) - (lx1-px1) * (ly2-ly1));
-            auto den = std::sqrt(std::pow(lx2-lx1, 2) - std::pow(ly2-ly1, 2));
-            return num/den;
-        }
-
     private:
-
-        // the bottommost point
-        std::pair<int, std::pair<double, double>> pivot;
-
-        double squareDistance(std::pair<double, double> p1, std::pair<double, double> p2)
+        // > 0 if o -> a -> b forms a counter-clockwise turn, < 0 if clockwise, 0 if collinear
+        static double cross(const std::pair<double, double> & o, const std::pair<double, double> & a,
+                            const std::pair<double, double> & b)
         {
-            return (p2.first - p1.first) * (p2.first - p1.first) + (p2.second - p1.second) * (p2.second - p1.second);
-        }
-
-        int orientation(std::pair<double, double> p1, std::pair<double, double> p2, std::pair<double, double> p3)
-        {
-            double area = (p2.first - p1.first) * (p3.second - p1.second) - (p2.second - p1.second) * (p3.first - p1.first);
-            if (area > 0)
-                return -1; // if a -> b -> c forms a counter-clockwise turn
-            else if (area < 0)
-                return 1; // if a -> b -> c forms a clockwise turn
-            return 0; // if a -> b -> c are collinear
-        }
-
-        // comparison is done first on y coordinate and then on x coordinate
-        bool pointComp(std::pair<double, double> p1, std::pair<double, double> p2)
-        {
-            if (p1.second != p2.second)
-                return p1.second < p2.second;
-            return p1.first != p2.first;
-        }
-
-        // sort function rule used for sorting points according to the pivot
-        bool compare(std::pair<int, std::pair<double, double>> p1, std::pair<int, std::pair<double, double>> p2)
-        {
-            int order = orientation(pivot.second, p1.second, p2.second);
-            if (order == 0)
-                return squareDistance(pivot.second, p1.second) < squareDistance(pivot.second, p2.second);
-            return (order == -1);
-        }
-
-        std::stack<std::pair<int, std::pair<double, double>>> grahamScan(std::vector<std::pair<int, std::pair<double, double>>> & points, int N)
-        {
-            std::stack<std::pair<int, std::pair<double, double>>> hull_;
-
-            if (N < 3)
-                return hull_;
-
-            // find the pivot bottommost point (lowest y coordinate)
-            int leastY = 0;
-            for (int i = 1; i < N; i++)
-                if (pointComp(points[i].second, points[leastY].second))
-                    leastY = i;
-
-            // swap the pivot with the first point
-            auto temp = points[0];
-            points[0] = points[leastY];
-            points[leastY] = temp;
-
-            // sort the remaining point according to polar order about the pivot
-            pivot = points[0];
-            std::sort(points.begin(), points.end(),
-                      std::bind(&ConvexHull::compare, this, std::placeholders::_1, std::placeholders::_2));
-
-            hull_.push(points[0]);
-            hull_.push(points[1]);
-            hull_.push(points[2]);
-
-            for (int i = 3; i < N; i++) {
-                std::pair<int, std::pair<double, double>> top = hull_.top();
-                hull_.pop();
-                while (hull_.size() > 1 && orientation(hull_.top().second, top.second, points[i].second) != -1)   {
-                    top = hull_.top();
-                    hull_.pop();
-                }
-                hull_.push(top);
-                hull_.push(points[i]);
-            }
-            return hull_;
+            return (a.first - o.first) * (b.second - o.second) - (a.second - o.second) * (b.first - o.first);
         }
 
         void getConvexHull(const Data & data)
@@ -150,13 +92,33 @@ namespace cvrp_joao
             for (int i = 1; i <= data.nbCustomers; ++i)
                 points.emplace_back(i, std::make_pair(data.customers[i].x, data.customers[i].y));
 
-            auto hull_ = grahamScan(points, data.nbCustomers + 1);
-            while (!hull_.empty())
+            // sorting by x coordinate and then by y coordinate
+            std::sort(points.begin(), points.end(), [](const std::pair<int, std::pair<double, double>> & p1,
+                                                       const std::pair<int, std::pair<double, double>> & p2) {
+                return p1.second < p2.second;
+            });
+            if (points.size() < 3)
             {
-                auto p = hull_.top();
-                hull.push_back(p);
-                hull_.pop();
+                hull = points;
+                return;
             }
+
+            // lower chain from left to right, then upper chain from right to left
+            hull.assign(2 * points.size(), points.front());
+            size_t k = 0;
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                while (k >= 2 && cross(hull[k - 2].second, hull[k - 1].second, points[i].second) <= 0)
+                    k--;
+                hull[k++] = points[i];
+            }
+            for (size_t i = points.size() - 1, lower = k + 1; i > 0; --i)
+            {
+                while (k >= lower && cross(hull[k - 2].second, hull[k - 1].second, points[i - 1].second) <= 0)
+                    k--;
+                hull[k++] = points[i - 1];
+            }
+            hull.resize(k - 1); // the first point is repeated at the end
         }
     };
 
@@ -166,22 +128,60 @@ namespace cvrp_joao
 
     public:
         void loadBranchingFeatures(const Data & data, int nbCandidates_);
-        void updateBranchingFeatures(const Data & data, const std::vector<std::vector<double> > & xSolution,
+        // nodeId is the sequence number of the branching call and depth is -1 when unknown
+        void updateBranchingFeatures(const Data & data, int nodeId, int depth, const SparseXSolution & xSolution,
                                   const std::vector<std::vector<double> > & xReducedCost,
                                   const std::vector<std::vector<int> > & xNbColumns);
 
+        /// When the feature log is open, the features are written to it instead of being printed
+        bool openFeatureLog(const std::string & fileName) { return featureLog.open(fileName); };
+        void closeFeatureLog() { featureLog.close(); };
+        // Dual bound gain of a child of the node 'nodeId', branched on the edge (firstNode, secondNode)
+        void recordOutcome(int nodeId, int firstNode, int secondNode, bool up, double gain);
+
+        bool loadScorer(const std::string & fileName) { return scorer.load(fileName); };
+        bool hasScorer() const { return scorer.isLoaded(); };
+        // Scores of the learned model for the given edges (i < j), in one batch. Must be called after
+        // updateBranchingFeatures() for the same solution. The feature store is not modified
+        void scoreEdges(const Data & data, const std::vector<std::pair<int, int>> & edges,
+                        const SparseXSolution & xSolution, const std::vector<std::vector<double> > & xReducedCost,
+                        const std::vector<std::vector<int> > & xNbColumns, std::vector<double> & scores);
+
     private:
-        std::map<std::string, EdgeFeatures> edgeFeatures;
+        EdgeFeatureStore edgeFeatures;
         std::vector<std::pair<int, std::pair<double, double>>> convexHull;
         int nbCandidates;
-        std::vector<std::pair<int, int>> neighbors;
-
-        BranchingFeatures() : edgeFeatures(), convexHull(), nbCandidates(0), neighbors() {}
+        int lastNodeId; // node of the last call of updateBranchingFeatures
+        /// Geometry of the nodes, computed once at load
+        std::vector<std::pair<int, int>> neighbors; // two nearest nodes
+        std::vector<double> hullDistance; // distance to the nearest facet (line) of the convex hull
+        std::vector<std::pair<std::pair<int, int>, double>> candidates; // kept between calls
+        /// Sum of the demands of the LP neighbors of each node and number of LP neighbors, for the current solution
+        std::vector<double> lpNeighborsDemand;
+        std::vector<int> lpDegree;
+        FeatureLog featureLog;
+        BranchingScorer scorer;
+        std::vector<double> scorerInput;
+
+        BranchingFeatures() : edgeFeatures(), convexHull(), nbCandidates(0), lastNodeId(-1), neighbors(), hullDistance(),
+                              candidates(), lpNeighborsDemand(), lpDegree(), featureLog(), scorer(), scorerInput() {}
 
         static bool sortRule(const std::pair<std::pair<int, int>, double> & a, const std::pair<std::pair<int, int>, double> & b);
-        static void printFeatures(const std::string & name, const EdgeFeatures & features);
-        static double getSumDemandsNeighbors(int firstNode, int secondNode, const Data & data,
-                                          const std::vector<std::vector<double> > & xSolution);
+        int updateEdgeFeatures(const Data & data, int firstNode, int secondNode, const SparseXSolution & xSolution,
+                               const std::vector<std::vector<double> > & xReducedCost,
+                               const std::vector<std::vector<int> > & xNbColumns);
+        // cost, distDepot, distConvexHull, distNearestNeighbor and sumDemandsEndpoints of the edge
+        void getInstanceFeatures(const Data & data, int firstNode, int secondNode, double * values) const;
+        void getScorerFeatures(const Data & data, int firstNode, int secondNode, const SparseXSolution & xSolution,
+                               const std::vector<std::vector<double> > & xReducedCost,
+                               const std::vector<std::vector<int> > & xNbColumns, double * values) const;
+        void printFeatures(int row) const;
+        void logFeatures(int nodeId, int depth, int row);
+        void computeNearestNeighbors(const Data & data);
+        void computeHullDistances(const Data & data);
+        void updateNeighborsDemand(const Data & data, const SparseXSolution & xSolution);
+        double getSumDemandsNeighbors(int firstNode, int secondNode, const Data & data,
+                                      const SparseXSolution & xSolution) const;
 
     };
 
@@ -0,0 +1,60 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef CVRP_JOAO_BRANCHINGSCORER_H
+#define CVRP_JOAO_BRANCHINGSCORER_H
+
+#include <string>
+#include <vector>
+
+namespace cvrp_joao
+{
+    // Learned scorer of the branching candidate edges, loaded from a text file. The features are those of the
+    // branching features log, by name (featureNames below), and the score is the predicted strong branching score
+    // (the higher, the better). Lines starting with '#' are comments. A linear model is:
+    //     linear
+    //     bias <value>
+    //     <feature name> <weight>          (one line per used feature)
+    // Gradient boosted trees (the score is the bias plus the values of the leaves reached in all trees) are:
+    //     gbt
+    //     bias <value>
+    //     tree <nb. of nodes>
+    //     split <feature name> <threshold> <left> <right>   or   leaf <value>   (one line per node, the root first)
+    // where <left> and <right> are the positions of the children in the tree, and the left child is taken when the
+    // feature is smaller than the threshold
+    class BranchingScorer
+    {
+    public:
+        static const int nbFeatures = 12;
+        static const char * const featureNames[nbFeatures];
+
+        BranchingScorer() : modelType(ModelType::None), bias(0.0), weights(), treeRoots(), nodeFeature(),
+                            nodeThreshold(), nodeLeft(), nodeRight(), nodeValue() {}
+
+        bool load(const std::string & fileName);
+        bool isLoaded() const { return modelType != ModelType::None; }
+        // Scores of nbRows candidates, whose features are column-major (feature k of row r at k * nbRows + r)
+        void predict(const double * features, int nbRows, double * scores) const;
+
+    private:
+        enum class ModelType { None, Linear, GradientBoostedTrees };
+
+        ModelType modelType;
+        double bias;
+        std::vector<double> weights; // by feature
+        /// Nodes of all trees; a leaf has feature -1, and the children are absolute positions
+        std::vector<int> treeRoots;
+        std::vector<int> nodeFeature;
+        std::vector<double> nodeThreshold;
+        std::vector<int> nodeLeft;
+        std::vector<int> nodeRight;
+        std::vector<double> nodeValue;
+
+        static int getFeature(const std::string & name);
+    };
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef CVRP_JOAO_CLUSTEREDGESTORE_H
+#define CVRP_JOAO_CLUSTEREDGESTORE_H
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cvrp_joao
+{
+    // Flat store of the edge sets delta(C_k) and E(C_k, C_l) of a cluster family, indexed by cluster ids.
+    // The edge sets only depend on the clusters, so each one is built once, the first time the cluster (pair)
+    // becomes a branching candidate, and then shared by all B&B nodes. Building them all at load time would need
+    // O(sum of |C_k| * n) memory for the (nested) MST/TSP cluster families
+    class ClusterEdgeStore
+    {
+    public:
+        struct Span
+        {
+            int begin;
+            int end;
+        };
+
+        ClusterEdgeStore() : edges(), spans(), nbErasedEdges(0), erasedIds(), spanOrder() {}
+
+        // Edges (i,j), i < j, with exactly one endpoint in the cluster. 'inCluster(i)' tells if i belongs to it
+        template <typename InCluster>
+        Span boundary(int clusterId, const std::vector<int> & cluster, int nbNodes, InCluster inCluster)
+        {
+            auto it = spans.find(key(clusterId, -1));
+            if (it != spans.end())
+                return it->second;
+
+            Span span{(int) edges.size(), 0};
+            reserve(cluster.size() * (nbNodes - cluster.size()));
+            for (int i = 0; i < nbNodes; ++i)
+            {
+                if (inCluster(i))
+                    continue;
+
+                for (const int & j : cluster)
+                    edges.emplace_back(std::min(i, j), std::max(i, j));
+            }
+            span.end = (int) edges.size();
+            spans.emplace(key(clusterId, -1), span);
+            return span;
+        }
+
+        // Edges (i,j), i < j, between two disjoint clusters
+        Span between(int firstClusterId, const std::vector<int> & firstCluster,
+                     int secondClusterId, const std::vector<int> & secondCluster)
+        {
+            auto it = spans.find(key(firstClusterId, secondClusterId));
+            if (it != spans.end())
+                return it->second;
+
+            Span span{(int) edges.size(), 0};
+            reserve(firstCluster.size() * secondCluster.size());
+            for (const int & i : firstCluster)
+                for (const int & j : secondCluster)
+                    edges.emplace_back(std::min(i, j), std::max(i, j));
+            span.end = (int) edges.size();
+            spans.emplace(key(firstClusterId, secondClusterId), span);
+            return span;
+        }
+
+        // Removes the edge sets of the given clusters, including those between them and other clusters. The spans
+        // of the other sets stay valid until the edges of the removed sets outnumber theirs; the store is then
+        // compacted, so its size stays linear in the size of the kept sets
+        void erase(const std::vector<int> & clusterIds)
+        {
+            if (clusterIds.empty())
+                return;
+
+            erasedIds.assign(clusterIds.begin(), clusterIds.end());
+            std::sort(erasedIds.begin(), erasedIds.end());
+            auto erased = [this](int clusterId) {
+                return std::binary_search(erasedIds.begin(), erasedIds.end(), clusterId);
+            };
+            for (auto it = spans.begin(); it != spans.end(); )
+            {
+                auto firstClusterId = (int) (it->first >> 32), secondClusterId = (int) (unsigned int) it->first;
+                if (erased(firstClusterId) || (secondClusterId != -1 && erased(secondClusterId)))
+                {
+                    nbErasedEdges += it->second.end - it->second.begin;
+                    it = spans.erase(it);
+                }
+                else
+                    ++it;
+            }
+            if (2 * nbErasedEdges > (int) edges.size())
+                compact();
+        }
+
+        const std::pair<int, int> & edge(int k) const { return edges[k]; }
+        int size() const { return (int) edges.size(); }
+        void clear() { edges.clear(); spans.clear(); nbErasedEdges = 0; }
+
+    private:
+        std::vector<std::pair<int, int>> edges;
+        std::unordered_map<long long, Span> spans;
+        int nbErasedEdges; // edges of the erased sets still in 'edges'
+        std::vector<int> erasedIds;
+        std::vector<Span *> spanOrder;
+
+        // Moves the edges of the kept sets to the front, in their order, and updates their spans
+        void compact()
+        {
+            spanOrder.clear();
+            for (auto & keySpan : spans)
+                spanOrder.push_back(&keySpan.second);
+            std::sort(spanOrder.begin(), spanOrder.end(), [](const Span * a, const Span * b) { return a->begin < b->begin; });
+            int nbEdges = 0;
+            for (auto & span : spanOrder)
+            {
+                auto length = span->end - span->begin;
+                std::move(edges.begin() + span->begin, edges.begin() + span->end, edges.begin() + nbEdges);
+                span->begin = nbEdges;
+                span->end = nbEdges + length;
+                nbEdges += length;
+            }
+            edges.resize(nbEdges);
+            nbErasedEdges = 0;
+        }
+
+        // Room for k more edges; the capacity grows geometrically, so filling the store stays linear overall
+        void reserve(std::size_t k)
+        {
+            if (edges.size() + k > edges.capacity())
+                edges.reserve(std::max(2 * edges.capacity(), edges.size() + k));
+        }
+
+        static long long key(int firstClusterId, int secondClusterId)
+        {
+            return ((long long) firstClusterId << 32) | (unsigned int) secondClusterId;
+        }
+    };
+}
+
+#endif
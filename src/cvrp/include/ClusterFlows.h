@@ -0,0 +1,121 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef CVRP_JOAO_CLUSTERFLOWS_H
+#define CVRP_JOAO_CLUSTERFLOWS_H
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "SparseXSolution.h"
+
+namespace cvrp_joao
+{
+    // Flows of a cluster family in a LP solution, used by the cluster branching candidates: the flow leaving each
+    // cluster, x(delta(C_k)), and the flow between each pair of disjoint clusters, x(E(C_k, C_l)). A family gives its
+    // clusters as (id, vertices), the positions in 'clusters' of the clusters containing each vertex
+    // (vertexClusters), customerInCluster(vertex, id) and isDisjoint(id, id).
+    // The pair flows are (pair key, value) entries, with the key k * nbClusters + l for the positions k < l, as only
+    // a few pairs have positive flow
+
+    typedef std::pair<long long, double> PairFlow;
+    typedef std::pair<std::pair<int, int>, double> WeightedEdge;
+
+    // Contribution of the edge (i,j) with the given value. Clusters may overlap, so each endpoint is mapped to all
+    // clusters containing it
+    template <typename ClusterFamily>
+    void addEdgeFlows(const ClusterFamily & family, int i, int j, double value, std::vector<double> & boundaryFlow,
+                      std::vector<PairFlow> & pairFlows)
+    {
+        auto nbClusters = (long long) family.clusters.size();
+        for (const int & k : family.vertexClusters[i])
+        {
+            auto firstClusterId = family.clusters[k].first;
+            if (!family.customerInCluster(j, firstClusterId))
+                boundaryFlow[k] += value;
+
+            for (const int & l : family.vertexClusters[j])
+                if (k != l && family.isDisjoint(firstClusterId, family.clusters[l].first))
+                    pairFlows.emplace_back(std::min(k, l) * nbClusters + std::max(k, l), value);
+        }
+        for (const int & l : family.vertexClusters[j])
+            if (!family.customerInCluster(i, family.clusters[l].first))
+                boundaryFlow[l] += value;
+    }
+
+    // Single pass over the positive edges to get the cluster flows; the pair flows are sorted by key (a pair may
+    // have several entries)
+    template <typename ClusterFamily>
+    void getClusterFlows(const SparseXSolution & xSolution, const ClusterFamily & family,
+                         std::vector<double> & boundaryFlow, std::vector<PairFlow> & pairFlows)
+    {
+        boundaryFlow.assign(family.clusters.size(), 0.0);
+        pairFlows.clear();
+        for (int e = 0; e < xSolution.nbEdges(); e++)
+            addEdgeFlows(family, xSolution.edgeFirstNode(e), xSolution.edgeSecondNode(e), xSolution.edgeLPValue(e),
+                         boundaryFlow, pairFlows);
+        std::sort(pairFlows.begin(), pairFlows.end(),
+                  [](const PairFlow & a, const PairFlow & b) { return a.first < b.first; });
+    }
+
+    // Changed edges between two edge lists sorted by (i,j): (i,j) and the change of x_ij. Returns false, with a
+    // partial list, as soon as there are more than maxNbChanges changed edges
+    inline bool getChangedEdges(const std::vector<WeightedEdge> & previousEdges,
+                                const std::vector<WeightedEdge> & currentEdges, double maxNbChanges,
+                                std::vector<WeightedEdge> & changedEdges)
+    {
+        changedEdges.clear();
+        for (size_t a = 0, b = 0; a < previousEdges.size() || b < currentEdges.size(); )
+        {
+            if (b == currentEdges.size() || (a < previousEdges.size() && previousEdges[a].first < currentEdges[b].first))
+            {
+                changedEdges.emplace_back(previousEdges[a].first, -previousEdges[a].second);
+                a++;
+            }
+            else if (a == previousEdges.size() || currentEdges[b].first < previousEdges[a].first)
+            {
+                changedEdges.push_back(currentEdges[b]);
+                b++;
+            }
+            else
+            {
+                if (currentEdges[b].second != previousEdges[a].second)
+                    changedEdges.emplace_back(currentEdges[b].first, currentEdges[b].second - previousEdges[a].second);
+                a++;
+                b++;
+            }
+            if (changedEdges.size() > maxNbChanges)
+                return false;
+        }
+        return true;
+    }
+
+    // Merges the pair flow changes (sorted here) in the pair flows sorted by key, keeping one entry per pair;
+    // the pairs without flow are removed
+    inline void mergePairFlows(std::vector<PairFlow> & pairFlows, std::vector<PairFlow> & pairFlowChanges)
+    {
+        auto byKey = [](const PairFlow & a, const PairFlow & b) { return a.first < b.first; };
+        std::sort(pairFlowChanges.begin(), pairFlowChanges.end(), byKey);
+        auto middle = pairFlows.size();
+        pairFlows.insert(pairFlows.end(), pairFlowChanges.begin(), pairFlowChanges.end());
+        std::inplace_merge(pairFlows.begin(), pairFlows.begin() + middle, pairFlows.end(), byKey);
+        size_t nbPairs = 0;
+        for (size_t p = 0; p < pairFlows.size(); )
+        {
+            auto key = pairFlows[p].first;
+            double value = 0.0;
+            for (; p < pairFlows.size() && pairFlows[p].first == key; p++)
+                value += pairFlows[p].second;
+            if (std::abs(value) > 1e-9)
+                pairFlows[nbPairs++] = std::make_pair(key, value);
+        }
+        pairFlows.resize(nbPairs);
+    }
+}
+
+#endif
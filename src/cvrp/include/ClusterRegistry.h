@@ -0,0 +1,49 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef DS_CLUSTERREGISTRY_H
+#define DS_CLUSTERREGISTRY_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ds
+{
+    // Set of clusters indexed by their canonical (sorted) form and a 64-bit hash of it. Each distinct cluster gets a
+    // stable id (firstId, firstId + 1, ... in insertion order), and insert/find run in O(|cluster|) expected time.
+    // An erased cluster frees its canonical form, but its id is not reused
+    class ClusterRegistry
+    {
+    public:
+        explicit ClusterRegistry(int firstId_ = 0) : firstId(firstId_), clusters(), index() {}
+
+        // Returns the id of the cluster and true if it was not registered yet
+        std::pair<int, bool> insert(const std::vector<int> & cluster);
+        // Returns the id of the cluster, or -1 if it is not registered
+        int find(const std::vector<int> & cluster) const;
+        // The cluster is no longer registered: inserting it again gives a new id
+        void erase(int id);
+
+        int size() const { return (int) clusters.size(); } // nb. of ids given, including the erased ones
+        void clear() { clusters.clear(); index.clear(); }
+        const std::vector<int> & cluster(int id) const { return clusters[id - firstId]; }
+
+        static uint64_t hash(const std::vector<int> & sortedCluster);
+        static uint64_t hash(const int * first, const int * last);
+
+    private:
+        int firstId;
+        std::vector<std::vector<int>> clusters; // canonical forms, by id - firstId
+        std::unordered_multimap<uint64_t, int> index;
+
+        int find(const std::vector<int> & sortedCluster, uint64_t key) const;
+        static std::vector<int> canonical(const std::vector<int> & cluster);
+    };
+}
+
+#endif
@@ -11,6 +11,8 @@
 #include "Data.h"
 #include "Parameters.h"
 #include "DisjointSets.h"
+#include "Bitset.h"
+#include "ClusterRegistry.h"
 
 #include <vector>
 #include <algorithm>
@@ -33,6 +35,7 @@ namespace cluster
         std::string routeClusterFilePath() const { return params->routeClusterFilePath(); };
         bool enableSingletons() const { return params->enableSingletons(); };
         bool enableBigClusters() const { return params->enableBigClusters(); };
+        bool enableSparseMST() const { return params->enableSparseMST(); };
 
         int clusterBranchingMode() const {
             return params->clusterBranchingMode() != 0 ? params->clusterBranchingMode() : 1;
@@ -109,6 +112,7 @@ namespace cluster
         std::vector<std::vector<int>> routeClusters;
         std::vector<int> vertexCluster;
         std::vector<int> vertexRouteCluster;
+        std::vector<std::vector<int>> vertexClusters; // positions in 'clusters' of all clusters containing the vertex
 
         static void printClusters(const std::vector<std::pair<int,std::vector<int>>> & clusters_);
         int nbClusters() const { return (int) clusters.size(); }
@@ -116,14 +120,14 @@ namespace cluster
         int nbTSPClusters() const { return nbTSPclusters; }
         int nbRoutes() const { return (int) routeClusters.size(); }
         int getVertexClusterId(int i, bool fromRouteCluster = false) const;
-        bool isDisjoint(int i, int j) const { return disjoint[i][j]; };
-        bool customerInCluster(int custId, int clustId) const { return clusterCustomers[clustId][custId]; };
+        bool isDisjoint(int i, int j) const { return !intersecting[i].test(j); };
+        bool customerInCluster(int custId, int clustId) const { return clusterCustomers[clustId].test(custId); };
 
     private:
         ClusteringParams clusteringParams;
         const cvrp_joao::Data *data;
-        std::vector<std::vector<bool>> disjoint;
-        std::vector<std::vector<bool>> clusterCustomers;
+        std::vector<ds::Bitset> intersecting; // bit j of row i is set if the clusters with ids i and j intersect
+        std::vector<ds::Bitset> clusterCustomers;
         int nbMSTclusters;
         int nbTSPclusters;
 
@@ -12,42 +12,61 @@
 #ifndef CVRP_JOAO_CUTSETS_H
 #define CVRP_JOAO_CUTSETS_H
 
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 
 #include "brnching.h"
 #include "cnstrmgr.h"
 
 #include "Data.h"
+#include "ClusterRegistry.h"
 
 namespace cvrp_joao
 {
-    using cutsetsMap = std::unordered_map<std::string, std::pair<std::vector<int>, double>>;
+    struct Cutset
+    {
+        int id; /// Stable id of the set, the same at all B&B nodes
+        std::vector<int> customers; /// Sorted customers in S
+        double rhs; /// Boundary x^*(\delta(S))
+    };
 
+    // Long-lived separator: the CVRPSEP constraint managers are created once and reused at every B&B node,
+    // and the sets found at previous nodes are kept in a bounded pool passed back to CVRPSEP as existing cuts
     class Cutsets
     {
         int nbCustomers;
+        int vehCapacity;
+        std::vector<int> demands; /// CVRPSEP demands, indexed by customer (1..nbCustomers)
         CnstrMgrPointer setsCMP; /// Data structure containing the cutsets
+        CnstrMgrPointer oldSetsCMP; /// Pool with the sets found in previous calls
         const bool verbose;
 
     public:
-        Cutsets(int nbCustomers_, int vehCapacity, std::vector<int> demands,
-                int nbEdges, std::vector<int> edgeTail,
-                std::vector<int> edgeHead, std::vector<double> edgeLPValue,
-                double target_ = 3.0, int nbSets_ = 0, bool verbose_ = false);
+        Cutsets(const Data & data, double target_ = 3.0, int nbSets_ = 0, int maxOldSets_ = 0, bool verbose_ = false);
+        Cutsets(const Cutsets &) = delete;
+        Cutsets & operator=(const Cutsets &) = delete;
 
-        ~Cutsets() = default;
+        ~Cutsets();
 
-        cutsetsMap getCutsets();
-        static void printCutsets(const cutsetsMap & myMap);
+        /// Edges arrays are 1-based (position 0 is not read), and the depot is numbered nbCustomers + 1
+        /// Only information on those edges e with LP value x_e > 0 should be passed
+        const std::vector<Cutset> & separate(int nbEdges, const int * edgeTail, const int * edgeHead,
+                                             const double * edgeLPValue);
+        static void printCutsets(const std::vector<const Cutset *> & sets);
 
     private:
         double boundaryTarget; /// Target value for x(delta(S)), it must be between 2.0 and 4.0
         int nbSets; /// The maximum number of identiﬁed sets
+        int maxOldSets; /// The maximum number of sets kept in the pool of previously found sets
+        ds::ClusterRegistry registry; /// All distinct sets found so far, its ids are the cutset ids
+        std::vector<Cutset> cutsets;
+        std::vector<int> lastSeparation; /// Last call where each cutset id was found (to remove duplicates)
+        int nbSeparations;
 
         double setTarget(double target_) const;
         int setNbOfSets(int nbSets_) const;
-        static std::string generateUniqueName(const std::vector<int> & vec);
+        void moveSetsToPool();
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -8,12 +8,14 @@
 #define CVRP_JOAO_DATA_H
 
 #include "Singleton.h"
+#include "DistanceMatrix.h"
 
 #include <vector>
 #include <string>
 #include <set>
 #include <limits>
 #include <cmath>
+#include <cstdint>
 
 #include <iostream>
 
@@ -61,27 +63,85 @@ namespace cvrp_joao
 
         double getCustToCustDistance(int firstCustId, int secondCustId) const
         {
-            return getDistance(customers[firstCustId].x, customers[firstCustId].y,
-                               customers[secondCustId].x, customers[secondCustId].y);
+            return getNodeToNodeDistance(firstCustId, secondCustId);
         }
 
         double getDepotToCustDistance(int custId) const
         {
-            return getDistance(depot_x, depot_y, customers[custId].x, customers[custId].y);
+            return getNodeToNodeDistance(0, custId);
+        }
+
+        /// Nodes are indexed as in the model: 0 is the depot and 1..nbCustomers are the customers
+        /// Reads the matrix of buildDistanceMatrix(), and computes the distance if it is not built yet
+        double getNodeToNodeDistance(int firstNodeId, int secondNodeId) const
+        {
+            if (integralDistances)
+                return intDistMatrix.row(firstNodeId)[secondNodeId];
+            if (!distMatrix.empty())
+                return distMatrix.row(firstNodeId)[secondNodeId];
+            return getDistance(nodeX(firstNodeId), nodeY(firstNodeId), nodeX(secondNodeId), nodeY(secondNodeId));
+        }
+
+        /// Precomputes the depot-inclusive distance matrix, must be called once the customers are loaded.
+        /// When distances are rounded to integers, they are stored as int32 (half of the memory, exact comparisons)
+        void buildDistanceMatrix()
+        {
+            const int nbNodes = nbCustomers + 1;
+            integralDistances = (roundType == ROUND_CLOSEST);
+
+            // Padded coordinates (node 0 is the depot), the padding is never read back
+            ds::AlignedMatrix<double> coords;
+            coords.resize(2, nbNodes);
+            double * xCoord = coords.row(0);
+            double * yCoord = coords.row(1);
+            xCoord[0] = depot_x;
+            yCoord[0] = depot_y;
+            for (int i = 1; i < nbNodes; ++i)
+            {
+                xCoord[i] = customers[i].x;
+                yCoord[i] = customers[i].y;
+            }
+
+            distMatrix.clear();
+            intDistMatrix.clear();
+            if (integralDistances)
+                intDistMatrix.resize(nbNodes, nbNodes);
+            else
+                distMatrix.resize(nbNodes, nbNodes);
+
+            for (int i = 0; i < nbNodes; ++i)
+            {
+                if (integralDistances)
+                    ds::fillDistanceRow(xCoord[i], yCoord[i], xCoord, yCoord, nbNodes, distanceRounding(), nullptr,
+                                        intDistMatrix.row(i));
+                else
+                    ds::fillDistanceRow(xCoord[i], yCoord[i], xCoord, yCoord, nbNodes, distanceRounding(),
+                                        distMatrix.row(i), nullptr);
+            }
         }
 
     private:
+        ds::AlignedMatrix<double> distMatrix;
+        ds::AlignedMatrix<std::int32_t> intDistMatrix;
+        bool integralDistances;
+
         Data() :
             name(), nbCustomers(0), customers(1, Customer()), veh_capacity(0), minNumVehicles(0), maxNumVehicles(10000),
-            depot_x(0.0), depot_y(0.0), roundType(RoundType::NO_ROUND), serv_time(0.0), max_distance(1e6)
+            depot_x(0.0), depot_y(0.0), roundType(RoundType::NO_ROUND), serv_time(0.0), max_distance(1e6),
+            distMatrix(), intDistMatrix(), integralDistances(false)
         {}
 
         double getDistance(double x1, double y1, double x2, double y2) const
         {
-            double distance = sqrt((x2-x1) * (x2-x1) + (y2-y1) * (y2-y1) );
-            if (roundType == ROUND_CLOSEST)
-                return round(distance);
-            return distance;
+            return ds::getDistance(x1, y1, x2, y2, distanceRounding());
+        }
+
+        double nodeX(int nodeId) const { return (nodeId == 0) ? depot_x : customers[nodeId].x; }
+        double nodeY(int nodeId) const { return (nodeId == 0) ? depot_y : customers[nodeId].y; }
+
+        ds::DistanceRounding distanceRounding() const
+        {
+            return (roundType == ROUND_CLOSEST) ? ds::DistanceRounding::Closest : ds::DistanceRounding::None;
         }
     };
 }
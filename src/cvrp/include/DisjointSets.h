@@ -33,45 +33,137 @@ namespace ds
 
         //explicit Graph(double (*costFunction)(int, int), int n_);
         // Graph(double (cvrp_joao::Data::*costFunction)(int, int), cvrp_joao::Data &obj, int n_);
-        explicit Graph(const cvrp_joao::Data *data);
+        // If sparse, only the edges of an Euclidean MST are kept (see boruvkaEMST), otherwise the complete graph
+        explicit Graph(const cvrp_joao::Data *data, bool sparse = false);
         void addEdge(int x, int y, double weight);
+
+    private:
+        void boruvkaEMST(const cvrp_joao::Data *data);
+    };
+
+
+    // 2-d tree over the customers coordinates (ids 1..n), used to find for a vertex
+    // the nearest vertex belonging to another component (Boruvka step of the sparse MST)
+    class KdTree
+    {
+    public:
+        explicit KdTree(const cvrp_joao::Data *data);
+        void updateComponents(const std::vector<int> & component);
+        std::pair<int, double> nearestForeign(int i) const;
+
+    private:
+        struct Node
+        {
+            int begin, end; // range in ids
+            int left, right; // children (-1 if leaf)
+            int component; // component of all the vertices in the node (-1 if mixed)
+            double minX, maxX, minY, maxY;
+        };
+
+        std::vector<double> x, y;
+        std::vector<int> ids;
+        std::vector<int> vertexComponent;
+        std::vector<Node> nodes;
+
+        int build(int begin, int end);
+        int updateComponent(int nodeId);
+        void search(int nodeId, int i, int & best, double & bestSqDist) const;
+    };
+
+
+    // Single-linkage dendrogram (Kruskal merge tree) of a MST: the leaves are the vertices 1..n, and the node
+    // edgeNode(k) merges the two components joined by the k-th MST edge (the edges must be sorted by weight),
+    // at height = edge weight. The leaves of any node are contiguous in a DFS order, so clusters are read in O(size)
+    class Dendrogram : public Utils
+    {
+    public:
+        Dendrogram(int n_, const std::vector<Edge> & mstEdges);
+
+        int edgeNode(int k) const { return n + 1 + k; }
+        int nodeEdge(int node) const { return node - n - 1; }
+        bool isLeaf(int node) const { return node <= n; }
+        int leftChild(int node) const { return left[node]; }
+        int rightChild(int node) const { return right[node]; }
+        int size(int node) const { return nodeSize[node]; }
+        double height(int node) const { return nodeHeight[node]; }
+        int minVertex(int node) const { return nodeMinVertex[node]; }
+
+        // Sorted vertices of the node
+        std::vector<int> members(int node) const;
+        // Indices of the MST edges inside the node, in increasing order (weight)
+        std::vector<int> subtreeEdges(int node) const;
+        // Maximal nodes with height < cutOff, i.e. the components of the MST edges lighter than cutOff. If maxSize > 0,
+        // nodes bigger than maxSize are further split. The nodes are ordered by their smallest vertex
+        std::vector<int> cut(double cutOff, int maxSize = 0) const;
+        // Components of the first nbEdges MST edges, ordered by their smallest vertex
+        std::vector<int> components(int nbEdges) const;
+
+    private:
+        int n;
+        std::vector<int> left, right, parent;
+        std::vector<int> nodeSize, nodeMinVertex, leafBegin;
+        std::vector<double> nodeHeight;
+        std::vector<int> leafOrder;
+        std::vector<int> roots;
+
+        template <typename IsCluster>
+        std::vector<int> topDown(IsCluster isCluster) const;
     };
 
 
+    // Union-find over the elements 1..n (union by rank, iterative path halving). It can be reset, and its sets
+    // grouped, without reallocation as long as n does not grow
     class DisjointSets : public Utils
     {
     public:
-        explicit DisjointSets(int n);
+        explicit DisjointSets(int n = 0);
+        void reset(int n);
         int findParent(int i);
         void unionRank(int x, int y);
         void printDisjointSets(int firstSetId = 1);
+        // Groups the elements 1..n by set in O(n) and returns the nb. of sets. The sets are ordered by their smallest
+        // element and each one is sorted; set k is [setBegin(k), setEnd(k)), valid until the next call
+        int groupSets(int n);
+        int nbSets() const { return nbGroupedSets; }
+        const int * setBegin(int k) const { return setElements.data() + setStart[k]; }
+        const int * setEnd(int k) const { return setElements.data() + setStart[k + 1]; }
+        // Copy of the sets given by groupSets
         std::vector<std::vector<int>> getDisjointSets(int n, bool verbose = false, int firstSetId = 1);
 
     private:
-        int* parent;
-        int* rank;
-        std::vector<std::vector<int>> sets;
+        std::vector<int> parent;
+        std::vector<int> rank;
+        std::vector<int> setIndex; // set of each root
+        std::vector<int> setStart; // sets in CSR form: set k is setElements[setStart[k]..setStart[k + 1])
+        std::vector<int> setElements;
+        int nbGroupedSets;
     };
 
 
+    // Min cuts (Stoer-Wagner) of a graph given by its dense weight matrix. The buffers are kept between calls of
+    // compute(), so reusing the same object does not reallocate
     class MinimumCut : public Utils
     {
     public:
-        MinimumCut(std::vector<std::vector<double>> weight_, int n_);
-        int nbMinCuts() { return (int) cuts.size(); }
+        MinimumCut() : n(0), nbNodes(0), nbCuts(0), shrunk(), assigned(), vertexWeight(), bin(), cuts() {}
+        // Min cuts over the vertices 1..n_; the weights are overwritten while the vertices are shrunk
+        void compute(std::vector<std::vector<double>> & weight, int n_);
+        int nbMinCuts() { return nbCuts; }
         double value() { return cuts[0].second; }
         void printCuts();
 
     private:
         int n;
         int nbNodes;
+        int nbCuts; // the cuts are reused, so only the first nbCuts ones are valid
         std::vector<bool> shrunk;
+        std::vector<bool> assigned;
+        std::vector<double> vertexWeight;
         std::vector<std::vector<int>> bin;
-        std::vector<std::vector<double>> weight;
         std::vector<std::pair<std::vector<int>, double>> cuts;
 
-        void minCut();
-        std::pair<int, double> minCutPhase(int arbitraryVertex);
+        void addCut(int vertex, double cutValue);
+        std::pair<int, double> minCutPhase(std::vector<std::vector<double>> & weight, int arbitraryVertex);
     };
 }
 
@@ -0,0 +1,89 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef CVRP_JOAO_FEATURELOG_H
+#define CVRP_JOAO_FEATURELOG_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cvrp_joao
+{
+    // Binary columnar log of the branching features, for offline learning. The rows are appended to in-memory
+    // blocks, and the full blocks are written by a background thread, so the solver only copies a few values per row.
+    // File layout: magic, version, then a sequence of blocks. A block starts with its type, its nb. of rows, its nb.
+    // of int32 columns and its nb. of float64 columns, followed by the int columns and then by the real columns
+    // (the values of each column are contiguous). The columns of each block type are given by the names below
+    class FeatureLog
+    {
+    public:
+        static const uint32_t fileMagic = 0x4C464643; // "CFFL"
+        static const uint32_t fileVersion = 1;
+
+        enum BlockType : uint32_t
+        {
+            FeatureBlock = 1, // one row per (node, candidate edge)
+            OutcomeBlock = 2 // one row per child of a node branched on an edge
+        };
+        static const int nbFeatureIntColumns = 7;
+        static const int nbFeatureRealColumns = 9;
+        static const int nbOutcomeIntColumns = 4;
+        static const int nbOutcomeRealColumns = 1;
+        static const char * const featureIntColumns[nbFeatureIntColumns];
+        static const char * const featureRealColumns[nbFeatureRealColumns];
+        static const char * const outcomeIntColumns[nbOutcomeIntColumns];
+        static const char * const outcomeRealColumns[nbOutcomeRealColumns];
+
+        FeatureLog() : file(), fileName(), writer(), mutex(), blockReady(), fullBlocks(), freeBlocks(),
+                       featureBlock(), outcomeBlock(), closing(false), nbRows(0) {}
+        ~FeatureLog() { close(); }
+        FeatureLog(const FeatureLog &) = delete;
+        FeatureLog & operator=(const FeatureLog &) = delete;
+
+        bool open(const std::string & fileName_);
+        bool isOpen() const { return writer.joinable(); }
+        // The sizes of the arrays are given by the columns of the block type
+        void addRow(BlockType type, const int32_t * intValues, const double * realValues);
+        // Writes the pending rows and waits for the background thread
+        void close();
+
+    private:
+        struct Block
+        {
+            BlockType type;
+            int nbRows;
+            std::vector<std::vector<int32_t>> intColumns;
+            std::vector<std::vector<double>> realColumns;
+        };
+
+        static const int blockSize = 4096; // nb. of rows of a full block
+
+        std::ofstream file;
+        std::string fileName;
+        std::thread writer;
+        std::mutex mutex; // protects the block queues and 'closing'
+        std::condition_variable blockReady;
+        std::deque<Block> fullBlocks;
+        std::deque<Block> freeBlocks; // written blocks, reused to avoid reallocating the columns
+        Block featureBlock;
+        Block outcomeBlock;
+        bool closing;
+        long nbRows;
+
+        void initBlock(Block & block, BlockType type);
+        void pushBlock(Block & block);
+        void writeBlock(const Block & block);
+        void writerLoop();
+    };
+}
+
+#endif
@@ -9,38 +9,88 @@
 
 #include <vector>
 #include "Data.h"
+#include "SparseXSolution.h"
+#include "Bitset.h"
+#include "ClusterRegistry.h"
+#include "DisjointSets.h"
 #include "Singleton.h"
 
 namespace fracclu
 {
+    // Usefulness of a cluster of the pool, used to choose the clusters to evict when the pool is full
+    struct ClusterStats
+    {
+        int nbFractional; // nb. of times one of its branchings was a candidate
+        int nbSelected; // nb. of times one of its branchings was among the strong branching candidates
+        int nbBranched; // nb. of times one of its branchings was the branching constraint of a node
+        int insertedAt; // call where it was (last) inserted in the pool
+        int lastUsed; // last call where it was found or was a candidate
+
+        // Each event also counts in the weaker ones (a branched cluster was selected, a selected one was fractional),
+        // so the weights only need to order them: being branched on is the strongest evidence of usefulness
+        static constexpr double fractionalWeight = 1.0;
+        static constexpr double selectedWeight = 2.0;
+        static constexpr double branchedWeight = 4.0;
+
+        // Usefulness per call since its insertion, so that the clusters that were useful long ago age
+        double score(int nbCalls) const
+        {
+            return (fractionalWeight * nbFractional + selectedWeight * nbSelected + branchedWeight * nbBranched)
+                   / (nbCalls - insertedAt + 1);
+        }
+    };
+
     class FractionalClustering: public cvrp_joao::Singleton<fracclu::FractionalClustering>
     {
         friend class cvrp_joao::Singleton<fracclu::FractionalClustering>;
 
     public:
         std::vector<std::pair<int,std::vector<int>>> clusters;
+        std::vector<std::vector<int>> vertexClusters; // positions in 'clusters' of all clusters containing the vertex
+        std::vector<ClusterStats> clusterStats; // same positions as 'clusters'
 
-        void loadFractionalClustering(double threshold_, int n);
-        void updateClustersList(const cvrp_joao::Data & data, const std::vector<std::vector<double> > & xSolution);
-        void insertCluster(std::vector<int> clust) { clusters.emplace_back(clusters.size() + 1, clust); };
+        void loadFractionalClustering(double threshold_, int n, int maxNbClusters_ = 0, int gracePeriod_ = 5);
+        void updateClustersList(const cvrp_joao::Data & data, const cvrp_joao::SparseXSolution & xSolution);
+        void insertCluster(int clustId, const std::vector<int> & clust, int n);
         static void printClusters(const std::vector<std::pair<int,std::vector<int>>> & clusters_);
         void setThresholdValue(double value) { threshold = value; };
-        bool isDisjoint(int i, int j) const { return disjoint[i][j]; };
-        bool customerInCluster(int custId, int clustId){ return customerClusters[clustId][custId]; };
+        bool isDisjoint(int i, int j) const { return !intersecting[clusterSlot[i]].test(clusterSlot[j]); };
+        bool customerInCluster(int custId, int clustId) const { return customerClusters[clusterSlot[clustId]].test(custId); };
+        // Usefulness statistics of the cluster at position 'pos' in 'clusters'
+        void recordCandidate(int pos, bool selected);
+        // The cluster with id 'clustId' (if still in the pool) was in the branching constraint of a node
+        void recordBranched(int clustId);
+        // Ids of the clusters evicted by the last call of updateClustersList
+        const std::vector<int> & evictedClusterIds() const { return evictedIds; };
 
     private:
         double threshold;
+        int maxNbClusters; // 0 if the pool is not bounded
+        int gracePeriod; // nb. of calls after its insertion during which a cluster is not evicted
+        int nbCalls;
+        std::vector<int> evictedIds;
         // The depot is always a single cluster
         std::vector<int> depotCluster;
-        std::vector<std::vector<int>> newClusters;
-        std::vector<std::vector<bool>> customerClusters;
-        std::vector<std::vector<bool>> disjoint;
+        std::vector<std::pair<int,std::vector<int>>> newClusters;
+        // The membership and intersection bitsets are indexed by slots, which are reused after evictions,
+        // so their size is bounded by the pool size and not by the nb. of clusters ever found
+        std::vector<int> clusterSlot; // slot of each cluster id, -1 if evicted (one int per id ever given)
+        std::vector<int> freeSlots;
+        std::vector<ds::Bitset> customerClusters;
+        std::vector<ds::Bitset> intersecting; // bit j of row i is set if the clusters in slots i and j intersect
+        // Registry ids are the cluster ids. The evicted clusters are erased from it, so it only holds the clusters
+        // of the pool and an empty entry per evicted id: the ids name the branching constraints, so they are not reused
+        ds::ClusterRegistry registry;
+        ds::DisjointSets unionFind; // reset at each call
 
-        FractionalClustering() : clusters(), threshold(0.5), depotCluster(), newClusters(), customerClusters(), disjoint() {}
+        FractionalClustering() : clusters(), vertexClusters(), clusterStats(), threshold(0.5), maxNbClusters(0),
+                                 gracePeriod(5), nbCalls(0), evictedIds(), depotCluster(), newClusters(), clusterSlot(), freeSlots(),
+                                 customerClusters(), intersecting(), registry(1), unionFind() {}
 
-        void getNewClusters(const cvrp_joao::Data & data, const std::vector<std::vector<double> > & xSolution);
+        void getNewClusters(const cvrp_joao::Data & data, const cvrp_joao::SparseXSolution & xSolution);
         void removeDuplicates();
         void insertNewClusters(int n);
+        int evictClusters(int & firstNewCluster);
     };
 }
 
@@ -13,6 +13,7 @@
 #include "Clustering.h"
 #include "FractionalClustering.h"
 #include "BranchingFeatures.h"
+#include "PseudoCosts.h"
 
 namespace cvrp_joao
 {
@@ -22,7 +23,8 @@ namespace cvrp_joao
         InputUser() : data(Data::getInstance()), params(Parameters::getInstance()), subtree(Subtree::getInstance()),
                       clustering(cluster::Clustering::getInstance()),
                       fractionalClustering(fracclu::FractionalClustering::getInstance()),
-                      branchingFeatures(BranchingFeatures::getInstance())
+                      branchingFeatures(BranchingFeatures::getInstance()),
+                      pseudoCosts(PseudoCosts::getInstance())
         {}
 
         const Data & data;
@@ -31,6 +33,7 @@ namespace cvrp_joao
         const cluster::Clustering & clustering;
         fracclu::FractionalClustering & fractionalClustering;
         BranchingFeatures & branchingFeatures;
+        PseudoCosts & pseudoCosts;
     };
 }
 
@@ -16,6 +16,7 @@ namespace cvrp_joao
     class Data;
     class Parameters;
     class BranchingFeatures;
+    class PseudoCosts;
     class Subtree;
 
     class Loader
@@ -29,6 +30,7 @@ namespace cvrp_joao
         void loadFractionalClustering();
         void loadSubtree();
         void loadBranchingFeatures(int nbSBcandidates);
+        void loadBranchingHistory();
 
     private:
         Data & data;
@@ -37,6 +39,7 @@ namespace cvrp_joao
         cluster::Clustering & clustering;
         fracclu::FractionalClustering & fractionalClustering;
         BranchingFeatures & branchingFeatures;
+        PseudoCosts & pseudoCosts;
 
         bool loadCVRPFile(std::ifstream & ifs);
         bool loadSubtreeFile(std::ifstream & ifs, Subtree & subtree_, const std::vector<std::pair<int,std::vector<int>>> & clusters_);
@@ -40,6 +40,7 @@ namespace cvrp_joao
         ApplicationParameter<bool> enableCostlyEdgeBranching;
         ApplicationParameter<bool> enableEdgeBranching;
         ApplicationParameter<bool> enableRandomSBCandidates;
+        ApplicationParameter<double> edgeBranchingPriority;
 
         ApplicationParameter<bool> enableClusterBranching;
         ApplicationParameter<int> clusterBranchingMode;
@@ -51,6 +52,7 @@ namespace cvrp_joao
         ApplicationParameter<std::string> routeClusterFilePath;
         ApplicationParameter<bool> enableSingletons;
         ApplicationParameter<bool> enableBigClusters;
+        ApplicationParameter<bool> enableSparseMST;
 
         ApplicationParameter<bool> enableCutsetsBranching;
 
@@ -61,10 +63,18 @@ namespace cvrp_joao
 
         ApplicationParameter<bool> enableFracClustering;
         ApplicationParameter<double> thresholdValueFracClustering;
+        ApplicationParameter<int> maxNbFracClusters;
+        ApplicationParameter<int> fracClustersGracePeriod;
 
         ApplicationParameter<bool> enableMinCut;
 
         ApplicationParameter<bool> enableBranchingFeatures;
+        ApplicationParameter<bool> branchingVerbose;
+        ApplicationParameter<int> pseudoCostReliability;
+        ApplicationParameter<bool> pseudoCostPruning;
+        ApplicationParameter<std::string> branchingHistoryFile;
+        ApplicationParameter<std::string> branchingFeaturesFile;
+        ApplicationParameter<std::string> branchingScorerFile;
 
         ApplicationParameter<std::string> rootFracSolutionFilePath;
     };
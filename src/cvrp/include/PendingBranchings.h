@@ -0,0 +1,65 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef CVRP_JOAO_PENDINGBRANCHINGS_H
+#define CVRP_JOAO_PENDINGBRANCHINGS_H
+
+#include <utility>
+#include <vector>
+
+namespace cvrp_joao
+{
+    // Candidates kept at a node, used to find the branching that created a child node and its bound improvement
+    struct PendingBranching
+    {
+        int nodeId = -1;
+        int depth = -1;
+        double lpValue = 0.0;
+        int nbCandidates = 0;
+        std::vector<int> signatureArena; // signature of candidate c: [signatureStart[c], signatureStart[c + 1])
+        std::vector<int> signatureStart;
+        std::vector<double> values;
+        std::vector<std::pair<int, int>> edges; // (-1, -1) for the candidates that are not edges
+        std::vector<std::pair<int, int>> fracClusters; // ids of the fractional clusters, -1 if none
+        int branched = -1; // position of the candidate found in a child, -1 if none yet
+        bool downSeen = false;
+        bool upSeen = false;
+        bool active = false; // if the record is pending
+
+        void addCandidate(const int * signatureFirst, const int * signatureLast, double value,
+                          std::pair<int, int> edge, std::pair<int, int> fracClusterIds);
+        const int * signatureBegin(int c) const { return signatureArena.data() + signatureStart[c]; }
+        const int * signatureEnd(int c) const { return signatureArena.data() + signatureStart[c + 1]; }
+    };
+
+    // Last nodes whose children were not all seen yet, at most maxSize. The records are kept in a pool of
+    // maxSize + 1 entries whose vectors are reused, so after a few nodes recording a node does not allocate
+    class PendingBranchings
+    {
+    public:
+        explicit PendingBranchings(int maxSize_ = 8) : maxSize(maxSize_), records(maxSize_ + 1), order(), nextRecord(-1)
+        {
+            order.reserve(maxSize_ + 1);
+        }
+
+        // Empty record of a node, not pending until push() is called
+        PendingBranching & next(int nodeId, int depth, double lpValue);
+        // The record given by next() becomes the newest pending one; the oldest is dropped if there are too many
+        void push();
+        // Pending records from the oldest (0) to the newest (size() - 1)
+        int size() const { return (int) order.size(); }
+        PendingBranching & operator[](int k) { return records[order[k]]; }
+        void erase(int k);
+
+    private:
+        int maxSize;
+        std::vector<PendingBranching> records;
+        std::vector<int> order; // positions in 'records' of the pending records, oldest first
+        int nextRecord;
+    };
+}
+
+#endif
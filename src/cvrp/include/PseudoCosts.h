@@ -0,0 +1,78 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef CVRP_JOAO_PSEUDOCOSTS_H
+#define CVRP_JOAO_PSEUDOCOSTS_H
+
+#include "ClusterRegistry.h"
+#include "Data.h"
+#include "Singleton.h"
+
+#include <string>
+#include <vector>
+
+namespace cvrp_joao
+{
+    // Pseudo-costs of the branching constraints: the average dual bound improvement per unit of change of the
+    // constraint value, in the down (<= floor) and up (>= ceil) branches. The constraints are identified by their
+    // canonical signatures, so a constraint found by different families (or with different names) shares its history.
+    // A pseudo-cost is reliable when both directions were observed at least 'reliabilityThreshold' times.
+    // The history can be saved to a binary file and loaded by the next runs over the same instance (checked through a
+    // fingerprint of the coordinates, demands and capacity, as the signatures are made of customer ids)
+    class PseudoCosts : public Singleton<PseudoCosts>
+    {
+        friend class Singleton<PseudoCosts>;
+
+    public:
+        void loadPseudoCosts(int reliabilityThreshold_) { reliabilityThreshold = reliabilityThreshold_; };
+        // Returns the id of the constraint, or -1 if it has no history yet
+        int find(const std::vector<int> & signature) const { return registry.find(signature); };
+        void update(const std::vector<int> & signature, bool up, double unitGain);
+        void recordEvaluation(const std::vector<int> & signature) { entries[getId(signature)].nbEvaluated++; };
+        void recordBranched(const std::vector<int> & signature) { entries[getId(signature)].nbBranched++; };
+
+        bool isReliable(int id) const;
+        // Product score of the estimated gains of both branches; the average pseudo-costs are used for the
+        // directions without history (and for id -1)
+        double score(int id, double fractionalPart) const;
+        bool empty() const { return nbDown + nbUp == 0; };
+        int size() const { return (int) entries.size(); };
+
+        bool load(const std::string & fileName, const Data & data);
+        // True if an existing history file could not be loaded, which must then not be overwritten
+        bool isHistoryRejected() const { return historyRejected; };
+        bool save(const std::string & fileName, const Data & data) const;
+
+    private:
+        struct Entry
+        {
+            double sumDown;
+            double sumUp;
+            int nbDown;
+            int nbUp;
+            int nbEvaluated; // nb. of nodes where it was a strong branching candidate
+            int nbBranched; // nb. of nodes where it was the branching constraint
+        };
+
+        int reliabilityThreshold;
+        ds::ClusterRegistry registry;
+        std::vector<Entry> entries; // by registry id
+        double sumDown;
+        double sumUp;
+        int nbDown;
+        int nbUp;
+
+        bool historyRejected;
+
+        PseudoCosts() : reliabilityThreshold(8), registry(), entries(), sumDown(0.0), sumUp(0.0), nbDown(0), nbUp(0),
+                        historyRejected(false) {}
+
+        int getId(const std::vector<int> & signature);
+        static uint64_t getInstanceFingerprint(const Data & data);
+    };
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#ifndef CVRP_JOAO_SPARSEXSOLUTION_H
+#define CVRP_JOAO_SPARSEXSOLUTION_H
+
+#include <vector>
+
+namespace cvrp_joao
+{
+    // Positive edge variables x_ij (i < j, node 0 is the depot) of a LP solution, stored as an edge list
+    // sorted by (i,j) and as a symmetric adjacency structure (CSR) with the neighbors sorted by id.
+    // The buffers are kept between calls of clear(), so reusing the same object does not reallocate
+    class SparseXSolution
+    {
+    public:
+        explicit SparseXSolution(int nbNodes_ = 0);
+
+        void clear(int nbNodes_);
+        void addEdge(int i, int j, double value);
+        void finalize();
+
+        int nbNodes() const { return nNodes; }
+        int nbEdges() const { return (int) edgeValue.size(); }
+        int edgeFirstNode(int e) const { return edgeFirst[e]; }
+        int edgeSecondNode(int e) const { return edgeSecond[e]; }
+        double edgeLPValue(int e) const { return edgeValue[e]; }
+
+        // Neighbors of i are adjNode[k] for k in [adjBegin(i), adjEnd(i))
+        int adjBegin(int i) const { return rowStart[i]; }
+        int adjEnd(int i) const { return rowStart[i + 1]; }
+        int degree(int i) const { return rowStart[i + 1] - rowStart[i]; }
+        int adjNode(int k) const { return adjNodes[k]; }
+        double adjValue(int k) const { return adjValues[k]; }
+
+        // Value of x_ij (0.0 if the edge is not positive), in O(log(degree))
+        double value(int i, int j) const;
+        // Symmetric dense matrix of the values, in a buffer that is only reallocated if the nb. of nodes grows
+        void toDense(std::vector<std::vector<double>> & xDense) const;
+
+    private:
+        int nNodes;
+        std::vector<int> edgeFirst;
+        std::vector<int> edgeSecond;
+        std::vector<double> edgeValue;
+        std::vector<int> rowStart;
+        std::vector<int> adjNodes;
+        std::vector<double> adjValues;
+        std::vector<int> order;
+        std::vector<int> nodeAux;
+        std::vector<double> valueAux;
+        std::vector<int> fillPos;
+    };
+}
+
+#endif
@@ -10,6 +10,12 @@
 #include "Cutsets.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <numeric>
 #include <utility>
 #include "bcModelNetworkFlow.hpp"
 #include "bcProbConfigC.hpp"
@@ -18,9 +24,22 @@ cvrp_joao::UserBranchingFunctor::UserBranchingFunctor(const Data & data_,
                                                       const Parameters & params_,
                                                       const cluster::Clustering & clusters_,
                                                       fracclu::FractionalClustering & fractionalClustering_,
-                                                      BranchingFeatures & branchingFeatures_):
+                                                      BranchingFeatures & branchingFeatures_,
+                                                      PseudoCosts & pseudoCosts_):
         BcDisjunctiveBranchingConstrSeparationFunctor(), data(data_), params(params_), clusters(clusters_),
-        fractionalClusters(fractionalClustering_), branchingFeatures(branchingFeatures_), constrCount(0), cutsetsIdMap()
+        fractionalClusters(fractionalClustering_), branchingFeatures(branchingFeatures_), constrCount(0),
+        cutsets(data_, 3.0, data_.nbCustomers, 0, true), cutsetEdgeTail(), cutsetEdgeHead(), cutsetEdgeLPValue(),
+        cutsetMembers(data_.nbCustomers + 1), defaultClusterEdges(), fracClusterEdges(),
+        candidates(), signatureArena(), signatureHashes(), isDuplicate(), signatureScratch(),
+        duplicateScores(), nbSavedSBEvaluations(0),
+        pseudoCosts(pseudoCosts_), pendingBranchings(), signatureSide(), lpEdges(),
+        cachedLpEdges(), cachedFingerprint(0), cachedListMaxSize(0), cacheValid(false), aggregatedEdges(),
+        clusterBoundaryFlow(), clusterPairFlows(), routeDegree(), routeClusterIds(), vertexRoutes(), aggregatesValid(false),
+        nbIncrementalUpdates(0), nodeId(-1), nodeDepth(-1),
+        familyScores(), scorerPositions(), scorerEdges(), scorerScores(), scorerHeuristicScores(), scorerOrder(),
+        lpSolution(), aggregateEdgesAux(), changedEdges(), pairFlowChanges(), fracBoundaryFlow(), fracPairFlows(),
+        xReducedCosts(), xNbColumns(), xColumnStamp(), xReducedCostEntries(), xNbColumnEntries(), xNbStampedColumns(0),
+        xDenseSolution(), minimumCut()
 {}
 
 cvrp_joao::UserBranchingFunctor::~UserBranchingFunctor() = default;
@@ -39,50 +58,128 @@ bool cvrp_joao::UserBranchingFunctor::operator() (BcFormulation master, BcSoluti
     BcFormulation spForm = master.colGenSubProblemList().front();
     BcVarArray xVar(spForm, "X");
 
-    std::vector<std::vector<double> > xSolution(data.nbCustomers + 1, std::vector<double>(data.nbCustomers + 1, 0.0));
+    /// BaPCod may call the functor more than once for the same primal solution: the candidates selected in the
+    /// previous call are then reused, and only their constraints are built again
+    lpEdges.clear();
     for (const auto & bcVar : xVarSet)
+        if (bcVar.solVal() > 0)
+            lpEdges.emplace_back(std::make_pair(bcVar.id().first(), bcVar.id().second()), bcVar.solVal());
+    auto fingerprint = getFingerprint(lpEdges);
+    if (cacheValid && fingerprint == cachedFingerprint && candListMaxSize == cachedListMaxSize
+        && lpEdges == cachedLpEdges)
     {
-        int firstNodeId = bcVar.id().first();
-        int secondNodeId = bcVar.id().second();
-        xSolution[firstNodeId][secondNodeId] = bcVar.solVal();
-        xSolution[secondNodeId][firstNodeId] = bcVar.solVal();
+        nbCacheHits++;
+        if (params.branchingVerbose())
+            std::cout << "Branching candidates reused for the same primal solution: " << candidates.size() << std::endl;
+        for (const auto & candidate : candidates)
+            materializeCandidate(candidate, userBranching, xVar, returnBrConstrList);
+        return true;
     }
+    nbCacheMisses++;
+    auto start = std::chrono::steady_clock::now();
+    /// The depth is only known at the root and when the parent is found by the pseudo-cost update
+    nodeDepth = (nodeId == -1) ? 0 : -1;
+    nodeId++;
+
+    /// Only the positive edges are kept, so the branching families below work in O(nb. of positive edges)
+    SparseXSolution & xSolution = lpSolution;
+    xSolution.clear(data.nbCustomers + 1);
+    for (const auto & edge : lpEdges)
+        xSolution.addEdge(edge.first.first, edge.first.second, edge.second);
+    xSolution.finalize();
 
     if (!rootProcessed)
         saveRootFracSolution(xVarSet, data.name, params.rootFracSolutionFilePath());
 
+    if (params.pseudoCostReliability() > 0)
+        updatePseudoCosts(primalSol.cost(), xSolution);
+
+    /// The families only add the descriptors of their candidates; the constraints are built after the selection
+    candidates.clear();
+    updateAggregates(xSolution);
     if (params.enableClusterBranching())
-        bool success = branchingOverDefaultClusters(userBranching, xVar, xSolution, returnBrConstrList);
+        branchingOverDefaultClusters();
 
     if (params.enableRouteClusterBranching())
-        bool success = branchingOverRouteClusters(userBranching, xVar, xSolution, returnBrConstrList);
+        branchingOverRouteClusters();
 
     if (params.enableFracClustering())
-        bool success = branchingOverFractionalClusters(userBranching, xVar, xSolution, returnBrConstrList);
+        branchingOverFractionalClusters(xSolution);
 
     if (params.enableCutsetsBranching())
-        bool success = branchingOverCutsets(userBranching, xVar, xSolution, returnBrConstrList);
+        branchingOverCutsets(xSolution);
 
     if (params.enableMinCut())
         bool success = computeMinCut(xVar, xSolution);
 
     if (params.enableBranchingFeatures())
     {
-        auto xReducedCosts = getReducedCosts(spForm);
-        auto xNbColumns = getVarNbColumns(columnsInSol);
-        branchingFeatures.updateBranchingFeatures(data, xSolution, xReducedCosts, xNbColumns);
+        updateReducedCosts(spForm);
+        updateVarNbColumns(columnsInSol);
+        branchingFeatures.updateBranchingFeatures(data, nodeId, nodeDepth, xSolution, xReducedCosts, xNbColumns);
     }
 
     if (params.enableCostlyEdgeBranching())
-        bool success = branchingOverCostlyEdges(userBranching, xVar, xSolution, returnBrConstrList,
-                                                candListMaxSize);
+        branchingOverCostlyEdges(xSolution);
+
+    removeDuplicateCandidates();
+    selectCandidates(candListMaxSize);
+    if (params.pseudoCostReliability() > 0)
+        recordBranching(primalSol.cost());
+
+    cacheValid = true;
+    cachedFingerprint = fingerprint;
+    cachedListMaxSize = candListMaxSize;
+    cachedLpEdges.swap(lpEdges);
+    auto elapsedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    cacheMissTime += elapsedTime;
+    if (params.branchingVerbose())
+        std::cout << "Branching candidates generated in " << elapsedTime * 1000 << "ms" << std::endl;
+
+    for (const auto & candidate : candidates)
+        materializeCandidate(candidate, userBranching, xVar, returnBrConstrList);
 
     return true;
 }
 
-std::vector<std::vector<double>> cvrp_joao::UserBranchingFunctor::getReducedCosts(const BcFormulation & spForm) const
+uint64_t cvrp_joao::UserBranchingFunctor::getFingerprint(const std::vector<std::pair<std::pair<int, int>, double>> & edges)
+{
+    // FNV-1a over the edges and the bits of their values
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](uint64_t value) {
+        h ^= value;
+        h *= 1099511628211ULL;
+    };
+    for (const auto & edge : edges)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &edge.second, sizeof(bits));
+        mix(((uint64_t) (uint32_t) edge.first.first << 32) | (uint32_t) edge.first.second);
+        mix(bits);
+    }
+    return h;
+}
+
+long cvrp_joao::UserBranchingFunctor::nbCacheHits = 0;
+long cvrp_joao::UserBranchingFunctor::nbCacheMisses = 0;
+double cvrp_joao::UserBranchingFunctor::cacheMissTime = 0.0;
+
+void cvrp_joao::UserBranchingFunctor::printCacheStatistics()
+{
+    /// The time saved by a hit is estimated by the average time of the calls that generated the candidates
+    double savedTime = (nbCacheMisses > 0) ? nbCacheHits * cacheMissTime / nbCacheMisses : 0.0;
+    std::cout << "Branching candidates cache: " << nbCacheHits << " hit(s), " << nbCacheMisses << " miss(es), "
+              << "estimated saved time = " << savedTime << "s" << std::endl;
+}
+
+// The matrices are allocated once; each call only zeroes the entries written by the previous one
+void cvrp_joao::UserBranchingFunctor::updateReducedCosts(const BcFormulation & spForm)
 {
-    std::vector<std::vector<double>> xReducedCost(data.nbCustomers + 1, std::vector<double>(data.nbCustomers + 1, 0.0));
+    if ((int) xReducedCosts.size() != data.nbCustomers + 1)
+        xReducedCosts.assign(data.nbCustomers + 1, std::vector<double>(data.nbCustomers + 1, 0.0));
+    for (const auto & entry : xReducedCostEntries)
+        xReducedCosts[entry.first][entry.second] = 0.0;
+    xReducedCostEntries.clear();
     auto * probConfigPtr = spForm.probConfPtr();
     {
         auto & instVarPts = probConfigPtr->instVarPts();
@@ -96,21 +193,28 @@ std::vector<std::vector<double>> cvrp_joao::UserBranchingFunctor::getReducedCost
                 continue;
 
             // firstNodeId = iVarPtr->id().first(), secondNodeId = iVarPtr->id().second();
-            xReducedCost[iVarPtr->id().first()][iVarPtr->id().second()] = instVarRedCosts[varId];
+            xReducedCosts[iVarPtr->id().first()][iVarPtr->id().second()] = instVarRedCosts[varId];
+            xReducedCostEntries.emplace_back(iVarPtr->id().first(), iVarPtr->id().second());
 
             //if (firstNodeId == 2)
             //    std::cout << " RC[" << iVarPtr->name() << "]=" << instVarRedCosts[varId];
         }
     }
-
-    return xReducedCost;
 }
 
-std::vector<std::vector<int>> cvrp_joao::UserBranchingFunctor::getVarNbColumns(
-                                                    const std::list<std::pair<double, BcSolution>> & columnsInSol) const
+void cvrp_joao::UserBranchingFunctor::updateVarNbColumns(const std::list<std::pair<double, BcSolution>> & columnsInSol)
 {
-    std::vector<std::vector<int>> xNbColumns(data.nbCustomers + 1, std::vector<int>(data.nbCustomers + 1, 0));
-
+    if ((int) xNbColumns.size() != data.nbCustomers + 1)
+    {
+        xNbColumns.assign(data.nbCustomers + 1, std::vector<int>(data.nbCustomers + 1, 0));
+        xColumnStamp.assign(data.nbCustomers + 1, std::vector<int>(data.nbCustomers + 1, -1));
+    }
+    for (const auto & entry : xNbColumnEntries)
+        xNbColumns[entry.first][entry.second] = 0;
+    xNbColumnEntries.clear();
+    /// An edge is counted once per column: xColumnStamp[i][j] is the last column that counted it, and the columns
+    /// are numbered across calls
+    int & column = xNbStampedColumns;
     for (const auto & pair : columnsInSol)
     {
         // auto value = pair.first;
@@ -121,7 +225,7 @@ std::vector<std::vector<int>> cvrp_joao::UserBranchingFunctor::getVarNbColumns(
         if (arcIds.empty())
             continue;
 
-        std::set<std::pair<int, int>> xVarList;
+        column++;
         for (auto & arcId: arcIds)
         {
             int prev = network.getArc(arcId).tail().ref();
@@ -133,368 +237,689 @@ std::vector<std::vector<int>> cvrp_joao::UserBranchingFunctor::getVarNbColumns(
                 secondNode = prev;
             }
 
-            if (xVarList.count(std::make_pair(firstNode, secondNode)) != 0)
+            if (xColumnStamp[firstNode][secondNode] == column)
                 continue;
 
+            if (xNbColumns[firstNode][secondNode] == 0)
+                xNbColumnEntries.emplace_back(firstNode, secondNode);
             xNbColumns[firstNode][secondNode] += 1;
-            xVarList.insert(std::make_pair(firstNode, secondNode));
+            xColumnStamp[firstNode][secondNode] = column;
         }
     }
+}
 
-    return xNbColumns;
+// ##############################################################################################
+//  Aggregates of the default clusters and of the route clusters:
+//  They are kept between calls. The LP solutions of consecutive nodes usually differ on a few edges, so when
+//  the nb. of changed edges is small, the aggregates are updated with the value changes of those edges only
+// ##############################################################################################
+
+void cvrp_joao::UserBranchingFunctor::addEdgeRouteDegrees(int i, int j, double value)
+{
+    auto secondClusterId = clusters.getVertexClusterId(j, true);
+    if (secondClusterId != -1)
+        for (const int & r : vertexRoutes[i])
+            if (routeClusterIds[r] != secondClusterId)
+                routeDegree[r] += value;
+
+    auto firstClusterId = clusters.getVertexClusterId(i, true);
+    if (firstClusterId != -1)
+        for (const int & r : vertexRoutes[j])
+            if (routeClusterIds[r] != firstClusterId)
+                routeDegree[r] += value;
 }
 
-bool cvrp_joao::UserBranchingFunctor::branchingOverDefaultClusters(BcBranchingConstrArray & userBranching, BcVarArray & xVar,
-                                                                  const std::vector<std::vector<double> > & xSolution,
-                                                                  std::list<std::pair<BcConstr, std::string> > & returnBrConstrList)
+void cvrp_joao::UserBranchingFunctor::updateAggregates(const SparseXSolution & xSolution)
 {
-    double threshold = 0.1; /// should be between 0.0 and 0.5
-    /// In indices: the last pair identifies the branching
-    std::vector<std::vector<std::pair<int, int>>> indices;
-    /// In candidates: pair.first = pos. in indices, pair.second = fract. sol. part
-    std::vector<std::pair<int, double>> candidates;
+    double maxChangedRatio = 0.25; /// max. ratio of changed edges for an incremental update
+    int maxIncrementalUpdates = 50; /// the aggregates are recomputed after that to avoid rounding drift
+    bool defaultClusters = params.enableClusterBranching(), routeClusters = params.enableRouteClusterBranching();
+    if (!defaultClusters && !routeClusters)
+        return;
 
-    // Branching over cluster degree
-    for (const auto & cluster: clusters.clusters)
+    if (routeClusters && vertexRoutes.empty())
     {
-        double totalXvalueDeg = 0;
-        std::vector<std::pair<int, int>> indicesDeg;
-        for (int i = 0; i <= data.nbCustomers; ++i)
-        {
-            if (clusters.customerInCluster(i, cluster.first))
-                continue;
-
-            for (const int & j : cluster.second)
-            {
-                int firstNodeId = std::min(i, j), secondNodeId = std::max(i, j);
-                totalXvalueDeg += xSolution[firstNodeId][secondNodeId];
-                indicesDeg.emplace_back(firstNodeId, secondNodeId);
-            }
-        }
-        totalXvalueDeg /= 2.0; /// we should divide by 2 to have the number of paths
-        double fractionalPart = totalXvalueDeg - (int) totalXvalueDeg;
-        if (fractionalPart > threshold && fractionalPart < 1 - threshold)
+        vertexRoutes.resize(data.nbCustomers + 1);
+        for (int r = 0; r < clusters.nbRoutes(); r++)
         {
-            int indId = indices.size();
-            // last element identifies the branching name
-            indicesDeg.emplace_back(cluster.first, -1);
-            indices.push_back(indicesDeg);
-            candidates.emplace_back(indId, fractionalPart);
+            routeClusterIds.push_back(clusters.getVertexClusterId(clusters.routeClusters[r].front(), true));
+            for (const int & i : clusters.routeClusters[r])
+                vertexRoutes[i].push_back(r);
         }
     }
 
-    // Branching over aggregated edges between cluster
-    for (int k = 0; k < clusters.clusters.size(); k++)
+    /// Changed edges: (i,j) and the change of x_ij from the last solution (both edge lists are sorted)
+    auto & currentEdges = aggregateEdgesAux;
+    currentEdges.clear();
+    for (int e = 0; e < xSolution.nbEdges(); e++)
+        currentEdges.emplace_back(std::make_pair(xSolution.edgeFirstNode(e), xSolution.edgeSecondNode(e)),
+                                  xSolution.edgeLPValue(e));
+    bool incremental = aggregatesValid && nbIncrementalUpdates < maxIncrementalUpdates
+                       && getChangedEdges(aggregatedEdges, currentEdges, maxChangedRatio * currentEdges.size(), changedEdges);
+    if (!incremental)
     {
-        auto firstClusterId = clusters.clusters[k].first;
-        for (int l = k + 1; l < clusters.clusters.size(); l++)
-        {
-            auto secondClusterId = clusters.clusters[l].first;
-            if (!clusters.isDisjoint(firstClusterId, secondClusterId))
-                continue;
+        changedEdges = currentEdges;
+        clusterBoundaryFlow.assign(clusters.nbClusters(), 0.0);
+        clusterPairFlows.clear();
+        routeDegree.assign(clusters.nbRoutes(), 0.0);
+        nbIncrementalUpdates = 0;
+    }
+    else
+        nbIncrementalUpdates++;
+    if (params.branchingVerbose())
+        std::cout << "Cluster aggregates: " << (incremental ? "incremental" : "full") << " update over "
+                  << changedEdges.size() << " edge(s)" << std::endl;
+
+    pairFlowChanges.clear();
+    for (const auto & edge : changedEdges)
+    {
+        if (defaultClusters)
+            addEdgeFlows(clusters, edge.first.first, edge.first.second, edge.second, clusterBoundaryFlow, pairFlowChanges);
+        if (routeClusters)
+            addEdgeRouteDegrees(edge.first.first, edge.first.second, edge.second);
+    }
 
-            double totalXvalueBtwClusters = 0;
-            std::vector<std::pair<int, int>> indicesBtwClusters;
-            for (const int & i : clusters.clusters[k].second)
-            {
-                for (const int & j : clusters.clusters[l].second)
-                {
-                    int firstNodeId = std::min(i, j), secondNodeId = std::max(i, j);
-                    totalXvalueBtwClusters += xSolution[firstNodeId][secondNodeId];
-                    indicesBtwClusters.emplace_back(firstNodeId, secondNodeId);
-                }
-            }
+    mergePairFlows(clusterPairFlows, pairFlowChanges);
 
-            double fractionalPart = totalXvalueBtwClusters - (int) totalXvalueBtwClusters;
-            if (fractionalPart > threshold && fractionalPart < 1 - threshold) {
-                int indId = indices.size();
-                // last element identifies the branching name
-                indicesBtwClusters.emplace_back(firstClusterId, secondClusterId);
-                indices.push_back(indicesBtwClusters);
-                candidates.emplace_back(indId, fractionalPart);
-            }
-        }
+    aggregatedEdges.swap(currentEdges);
+    aggregatesValid = true;
+}
+
+void cvrp_joao::UserBranchingFunctor::branchingOverDefaultClusters()
+{
+    double threshold = 0.1; /// should be between 0.0 and 0.5
+    auto nbCandidates = candidates.size();
+
+    /// The cluster flows are the aggregates kept between calls (see updateAggregates)
+    auto nbClusters = clusters.nbClusters();
+    const auto & boundaryFlow = clusterBoundaryFlow;
+    const auto & pairFlows = clusterPairFlows;
+
+    // Branching over cluster degree
+    for (int k = 0; k < nbClusters; k++)
+    {
+        const auto & cluster = clusters.clusters[k];
+        double totalXvalueDeg = boundaryFlow[k];
+        totalXvalueDeg /= 2.0; /// we should divide by 2 to have the number of paths
+        double fractionalPart = totalXvalueDeg - (int) totalXvalueDeg;
+        if (fractionalPart > threshold && fractionalPart < 1 - threshold)
+            addCandidate(BranchingFamily::DefaultCluster, cluster.first, -1, totalXvalueDeg).positions = {k, -1};
     }
 
-    // Sort candidates by most fractional
-    sort(candidates.begin(), candidates.end(), sortRule);
-    std::cout << "CB candidates list size: " << candidates.size() << std::endl;
-    // To add the candidates in the list
-    for (auto cand : candidates)
+    // Branching over aggregated edges between cluster (only the pairs of disjoint clusters with positive flow)
+    for (size_t p = 0; p < pairFlows.size(); )
     {
-        auto candidateIndices = indices[cand.first];
-        double constMultiplier = 1.0;
-        std::string branchingName = "AggClusters[" + std::to_string(candidateIndices.back().first) +
-                                    "," + std::to_string(candidateIndices.back().second) + "]";
-        if (candidateIndices.back().second == -1) // Degree cluster branching
-        {
-            branchingName = "DegCluster " + std::to_string(candidateIndices.back().first);
-            constMultiplier = 0.5;
-        }
-        // std::cout << branchingName << std::endl;
-        BcConstr bcConstr = userBranching(constrCount++);
-        for (auto pair = candidateIndices.begin(); pair != std::prev(candidateIndices.end()); ++pair)
-            bcConstr += constMultiplier * xVar[pair->first][pair->second];
-        /// second parameter here is an unique string which characterizes the branching constraint
-        /// this string is used to keep the branching history
-        returnBrConstrList.emplace_back(bcConstr, branchingName);
+        auto key = pairFlows[p].first;
+        double totalXvalueBtwClusters = 0;
+        for (; p < pairFlows.size() && pairFlows[p].first == key; p++)
+            totalXvalueBtwClusters += pairFlows[p].second;
+
+        auto k = (int) (key / nbClusters), l = (int) (key % nbClusters);
+        double fractionalPart = totalXvalueBtwClusters - (int) totalXvalueBtwClusters;
+        if (fractionalPart > threshold && fractionalPart < 1 - threshold)
+            addCandidate(BranchingFamily::DefaultCluster, clusters.clusters[k].first, clusters.clusters[l].first,
+                         totalXvalueBtwClusters).positions = {k, l};
     }
 
-    return true;
+    std::cout << "CB candidates list size: " << candidates.size() - nbCandidates << std::endl;
 }
 
-bool cvrp_joao::UserBranchingFunctor::branchingOverRouteClusters(BcBranchingConstrArray & userBranching, BcVarArray & xVar,
-                                                                const std::vector<std::vector<double> > & xSolution,
-                                                                std::list<std::pair<BcConstr, std::string> > & returnBrConstrList)
+void cvrp_joao::UserBranchingFunctor::branchingOverRouteClusters()
 {
     double threshold = 0.1; /// should be between 0.0 and 0.5
-    for (const auto & firstCluster: clusters.routeClusters)
+    for (int r = 0; r < clusters.nbRoutes(); r++)
     {
-        int firstClusterId = clusters.getVertexClusterId(firstCluster.front(), true);
-        double totalXvalueDeg = 0;
-        std::vector<std::pair<int, int>> indicesDeg;
-        for (const auto & secondCluster: clusters.routeClusters)
-        {
-            int secondClusterId = clusters.getVertexClusterId(secondCluster.front(), true);
-            if (firstClusterId != secondClusterId)
-            {
-                for (const int & i: firstCluster)
-                {
-                    for (const int & j: secondCluster)
-                    {
-                        int firstNodeId = std::min(i, j), secondNodeId = std::max(i, j);
-                        totalXvalueDeg += xSolution[firstNodeId][secondNodeId];
-                        indicesDeg.emplace_back(firstNodeId, secondNodeId);
-                    }
-                }
-            }
-        }
+        /// The route cluster degrees are the aggregates kept between calls (see updateAggregates)
+        int firstClusterId = routeClusterIds[r];
+        double totalXvalueDeg = routeDegree[r];
         // Branching over cluster degree
         totalXvalueDeg /= 2.0; /// we should divide by 2 to have the number of paths
         double fractionalPart = totalXvalueDeg - (int) totalXvalueDeg;
         if (fractionalPart > threshold && fractionalPart < 1 - threshold)
-        {
-            BcConstr bcConstr = userBranching(constrCount++);
-            for (auto pair : indicesDeg)
-                bcConstr += 0.5 * xVar[pair.first][pair.second];
-            /// second parameter here is an unique string which characterizes the branching constraint
-            /// this string is used to keep the branching history
-            returnBrConstrList.emplace_back(bcConstr,"DegRouteCluster " + std::to_string(firstClusterId));
-        }
+            addCandidate(BranchingFamily::RouteCluster, firstClusterId, -1, totalXvalueDeg).positions = {r, -1};
     }
-
-    return true;
 }
 
-bool cvrp_joao::UserBranchingFunctor::branchingOverFractionalClusters(BcBranchingConstrArray & userBranching,
-                                                                      BcVarArray &xVar,
-                                                                      const std::vector<std::vector<double>> &xSolution,
-                                                                      std::list<std::pair<BcConstr, std::string>> &returnBrConstrList)
+void cvrp_joao::UserBranchingFunctor::branchingOverFractionalClusters(const SparseXSolution & xSolution)
 {
     std::cout << "Fractional clustering evaluation" << std::endl;
     fractionalClusters.updateClustersList(data, xSolution);
+    /// The cached edge sets of the evicted clusters are dropped, the others are kept (the cluster ids are stable)
+    fracClusterEdges.erase(fractionalClusters.evictedClusterIds());
 
     double threshold = 0.1; /// should be between 0.0 and 0.5
-    /// In indices: the last pair identifies the branching
-    std::vector<std::vector<std::pair<int, int>>> indices;
-    /// In candidates: pair.first = pos. in indices, pair.second = fract. sol. part
-    std::vector<std::pair<int, double>> candidates;
+    auto nbCandidates = candidates.size();
+
+    auto nbClusters = (int) fractionalClusters.clusters.size();
+    auto & boundaryFlow = fracBoundaryFlow;
+    auto & pairFlows = fracPairFlows;
+    getClusterFlows(xSolution, fractionalClusters, boundaryFlow, pairFlows);
 
     // Branching over cluster degree
-    for (auto & clust : fractionalClusters.clusters)
+    for (int k = 0; k < nbClusters; k++)
     {
-        double totalXvalueDeg = 0;
-        std::vector<std::pair<int, int>> indicesDeg;
-        for (int i = 0; i <= data.nbCustomers; ++i)
-        {
-            if (fractionalClusters.customerInCluster(i, clust.first))
-                continue;
+        double totalXvalueDeg = boundaryFlow[k];
+        totalXvalueDeg /= 2.0; /// we should divide by 2 to have the number of paths
+        double fractionalPart = totalXvalueDeg - (int) totalXvalueDeg;
+        if (fractionalPart > threshold && fractionalPart < 1 - threshold)
+            addCandidate(BranchingFamily::FractionalCluster, fractionalClusters.clusters[k].first, -1,
+                         totalXvalueDeg).positions = {k, -1};
+    }
 
-            for (const int & j : clust.second)
-            {
-                int firstNodeId = std::min(i, j), secondNodeId = std::max(i, j);
-                totalXvalueDeg += xSolution[firstNodeId][secondNodeId];
-                indicesDeg.emplace_back(firstNodeId, secondNodeId);
-            }
-        }
+    // Branching over aggregated edges between cluster (only the pairs of disjoint clusters with positive flow)
+    for (size_t p = 0; p < pairFlows.size(); )
+    {
+        auto key = pairFlows[p].first;
+        double totalXvalueBtwClusters = 0;
+        for (; p < pairFlows.size() && pairFlows[p].first == key; p++)
+            totalXvalueBtwClusters += pairFlows[p].second;
+
+        auto k = (int) (key / nbClusters), l = (int) (key % nbClusters);
+        double fractionalPart = totalXvalueBtwClusters - (int) totalXvalueBtwClusters;
+        if (fractionalPart > threshold && fractionalPart < 1 - threshold)
+            addCandidate(BranchingFamily::FractionalCluster, fractionalClusters.clusters[k].first,
+                         fractionalClusters.clusters[l].first, totalXvalueBtwClusters).positions = {k, l};
+    }
+
+    std::cout << "CB candidates list size: " << candidates.size() - nbCandidates << std::endl;
+}
+
+void cvrp_joao::UserBranchingFunctor::branchingOverCutsets(const SparseXSolution & xSolution)
+{
+    /// Filling the datastructures (the buffers are reused between calls; position 0 is not used by CVRPSEP)
+    /// the CVRPSEP default assume that the depot is numbered nbCustomers + 1
+    /// Only information on those edges e with LP value x_e > 0 should be passed
+    int nbEdges = xSolution.nbEdges();
+    cutsetEdgeTail.resize(nbEdges + 1);
+    cutsetEdgeHead.resize(nbEdges + 1);
+    cutsetEdgeLPValue.resize(nbEdges + 1);
+    for (int e = 0; e < nbEdges; e++) {
+        auto firstNodeId = xSolution.edgeFirstNode(e);
+        cutsetEdgeTail[e + 1] = (firstNodeId == 0) ? data.nbCustomers + 1 : firstNodeId;
+        cutsetEdgeHead[e + 1] = xSolution.edgeSecondNode(e);
+        cutsetEdgeLPValue[e + 1] = xSolution.edgeLPValue(e);
+    }
+
+    /// The cutsets have stable ids, shared by all B&B nodes
+    const auto & foundCutsets = cutsets.separate(nbEdges, cutsetEdgeTail.data(), cutsetEdgeHead.data(),
+                                                 cutsetEdgeLPValue.data());
+    /// The cutsets equal to clusters of the other families (or to their complements) are removed with the other
+    /// duplicate candidates
+    std::vector<const Cutset *> myCutsets;
+    for (const auto & cutset : foundCutsets)
+        myCutsets.push_back(&cutset);
+    Cutsets::printCutsets(myCutsets);
+
+    double threshold = 0.1; /// should be between 0.0 and 0.5
+    /// Branching over cutset degree
+    for (const auto & cutset : myCutsets) {
+        double totalXvalueDeg = cutset->rhs; /// Cutset RHS value
         totalXvalueDeg /= 2.0; /// we should divide by 2 to have the number of paths
         double fractionalPart = totalXvalueDeg - (int) totalXvalueDeg;
         if (fractionalPart > threshold && fractionalPart < 1 - threshold)
-        {
-            int indId = indices.size();
-            // last element identifies the branching name
-            indicesDeg.emplace_back(clust.first, -1);
-            indices.push_back(indicesDeg);
-            candidates.emplace_back(indId, fractionalPart);
-        }
+            addCandidate(BranchingFamily::Cutset, cutset->id, -1, totalXvalueDeg).set = &cutset->customers;
     }
+}
+
+// ##############################################################################################
+//  Unified candidate stage:
+//  The families only describe their candidates (ids, fractional part and a score); the best candListMaxSize
+//  candidates of all families are kept, and the branching constraints are built only for them
+// ##############################################################################################
+
+cvrp_joao::BranchingCandidate & cvrp_joao::UserBranchingFunctor::addCandidate(BranchingFamily family, int first,
+                                                                              int second, double value)
+{
+    BranchingCandidate candidate{};
+    candidate.family = family;
+    candidate.first = first;
+    candidate.second = second;
+    candidate.positions = {-1, -1};
+    candidate.signatureBegin = 0;
+    candidate.signatureEnd = 0;
+    candidate.value = value;
+    auto fractionalPart = value - (int) value;
+    candidate.fractionalPart = fractionalPart;
+    /// 1 for a fractional part of 0.5, 0 for an integer value
+    candidate.score = familyPriority(family) * (1.0 - 2.0 * std::abs(0.5 - fractionalPart));
+    candidates.push_back(candidate);
+    return candidates.back();
+}
 
-    // Branching over aggregated edges between cluster
-    for (int k = 0; k < fractionalClusters.clusters.size(); k++)
+double cvrp_joao::UserBranchingFunctor::familyPriority(BranchingFamily family) const
+{
+    /// Single edges usually give weaker branchings than the aggregated ones
+    return (family == BranchingFamily::CostlyEdge) ? params.edgeBranchingPriority() : 1.0;
+}
+
+// The signature of a candidate is a sorted vector: a negative tag for the kind of constraint, followed by its sets.
+// A degree constraint over delta(S) is equal to the one over delta(V \ S), so S is the side without the depot.
+// The second set of an aggregated edges constraint E(A, B) is shifted by nbNodes, and A is the set with the
+// smallest vertex; a single edge {i,j} is the constraint E({i}, {j}). The signature is appended to 'signature'
+void cvrp_joao::UserBranchingFunctor::addCandidateSignature(const BranchingCandidate & candidate,
+                                                            std::vector<int> & signature)
+{
+    auto nbNodes = data.nbCustomers + 1;
+    auto getCluster = [&](int pos) -> const std::vector<int> & {
+        return (candidate.family == BranchingFamily::DefaultCluster) ? clusters.clusters[pos].second
+                                                                     : fractionalClusters.clusters[pos].second;
+    };
+    auto addSet = [&](const std::vector<int> & set, int shift) {
+        auto begin = signature.size();
+        for (const int & i : set)
+            signature.push_back(i + shift);
+        std::sort(signature.begin() + begin, signature.end());
+    };
+    auto addDegreeSet = [&](const std::vector<int> & set) {
+        signature.push_back(DegreeTag);
+        if (std::find(set.begin(), set.end(), 0) == set.end())
+        {
+            addSet(set, 0);
+            return;
+        }
+        for (const int & i : set)
+            cutsetMembers.set(i);
+        for (int i = 1; i < nbNodes; i++)
+            if (!cutsetMembers.test(i))
+                signature.push_back(i);
+        for (const int & i : set)
+            cutsetMembers.reset(i);
+    };
+
+    switch (candidate.family)
     {
-        auto firstClusterId = fractionalClusters.clusters[k].first;
-        for (int l = k + 1; l < fractionalClusters.clusters.size(); l++)
+        case BranchingFamily::DefaultCluster:
+        case BranchingFamily::FractionalCluster:
         {
-            auto secondClusterId = fractionalClusters.clusters[l].first;
-            if (!fractionalClusters.isDisjoint(firstClusterId, secondClusterId))
+            const auto & first = getCluster(candidate.positions.first);
+            if (candidate.second == -1)
             {
-                // std::cout << "No disjoint: " << firstClusterId << " and " << secondClusterId << std::endl;
-                continue;
+                addDegreeSet(first);
+                break;
             }
+            const auto & second = getCluster(candidate.positions.second);
+            bool firstIsSmallest = *std::min_element(first.begin(), first.end()) <
+                                   *std::min_element(second.begin(), second.end());
+            signature.push_back(AggregatedTag);
+            addSet(firstIsSmallest ? first : second, 0);
+            addSet(firstIsSmallest ? second : first, nbNodes);
+            break;
+        }
+        case BranchingFamily::RouteCluster:
+            signature.push_back(RouteDegreeTag);
+            addSet(clusters.routeClusters[candidate.positions.first], 0);
+            break;
+        case BranchingFamily::Cutset:
+            addDegreeSet(*candidate.set);
+            break;
+        case BranchingFamily::CostlyEdge:
+            signature.push_back(AggregatedTag);
+            signature.push_back(candidate.first);
+            signature.push_back(candidate.second + nbNodes);
+            break;
+    }
+}
 
-            double totalXvalueBtwClusters = 0;
-            std::vector<std::pair<int, int>> indicesBtwClusters;
-            for (const int & i : fractionalClusters.clusters[k].second)
-            {
-                for (const int & j : fractionalClusters.clusters[l].second)
-                {
-                    int firstNodeId = std::min(i, j), secondNodeId = std::max(i, j);
-                    totalXvalueBtwClusters += xSolution[firstNodeId][secondNodeId];
-                    indicesBtwClusters.emplace_back(firstNodeId, secondNodeId);
-                }
-            }
+const std::vector<int> & cvrp_joao::UserBranchingFunctor::getCandidateSignature(const BranchingCandidate & candidate)
+{
+    signatureScratch.assign(signatureArena.begin() + candidate.signatureBegin,
+                            signatureArena.begin() + candidate.signatureEnd);
+    return signatureScratch;
+}
 
-            double fractionalPart = totalXvalueBtwClusters - (int) totalXvalueBtwClusters;
-            if (fractionalPart > threshold && fractionalPart < 1 - threshold) {
-                int indId = indices.size();
-                // last element identifies the branching name
-                indicesBtwClusters.emplace_back(firstClusterId, secondClusterId);
-                indices.push_back(indicesBtwClusters);
-                candidates.emplace_back(indId, fractionalPart);
-            }
-        }
+const std::vector<int> & cvrp_joao::UserBranchingFunctor::getPendingSignature(const PendingBranching & pending, int c)
+{
+    signatureScratch.assign(pending.signatureBegin(c), pending.signatureEnd(c));
+    return signatureScratch;
+}
+
+void cvrp_joao::UserBranchingFunctor::removeDuplicateCandidates()
+{
+    // The signatures of all candidates are stored in a single buffer and sorted by hash; among equal signatures,
+    // the first candidate in generation order is kept, so the first family that finds a constraint keeps it
+    signatureArena.clear();
+    signatureHashes.clear();
+    for (int c = 0; c < (int) candidates.size(); c++)
+    {
+        auto & candidate = candidates[c];
+        candidate.signatureBegin = (int) signatureArena.size();
+        addCandidateSignature(candidate, signatureArena);
+        candidate.signatureEnd = (int) signatureArena.size();
+        signatureHashes.emplace_back(ds::ClusterRegistry::hash(signatureArena.data() + candidate.signatureBegin,
+                                                               signatureArena.data() + candidate.signatureEnd), c);
+    }
+    std::sort(signatureHashes.begin(), signatureHashes.end());
+
+    isDuplicate.assign(candidates.size(), 0);
+    auto sameSignature = [&](const BranchingCandidate & a, const BranchingCandidate & b) {
+        return std::equal(signatureArena.begin() + a.signatureBegin, signatureArena.begin() + a.signatureEnd,
+                          signatureArena.begin() + b.signatureBegin, signatureArena.begin() + b.signatureEnd);
+    };
+    for (size_t first = 0; first < signatureHashes.size(); )
+    {
+        auto last = first;
+        while (last < signatureHashes.size() && signatureHashes[last].first == signatureHashes[first].first)
+            last++;
+        for (auto a = first; a < last; a++)
+            for (auto b = first; b < a && !isDuplicate[signatureHashes[a].second]; b++)
+                if (!isDuplicate[signatureHashes[b].second]
+                    && sameSignature(candidates[signatureHashes[a].second], candidates[signatureHashes[b].second]))
+                    isDuplicate[signatureHashes[a].second] = 1;
+        first = last;
     }
-    // Sort candidates by most fractional
-    sort(candidates.begin(), candidates.end(), sortRule);
-    std::cout << "CB candidates list size: " << candidates.size() << std::endl;
-    // To add the candidates in the list
-    for (auto cand : candidates)
+
+    duplicateScores.clear();
+    int nbKept = 0;
+    for (int c = 0; c < (int) candidates.size(); c++)
     {
-        auto candidateIndices = indices[cand.first];
-        double constMultiplier = 1.0;
-        std::string branchingName = "AggClusters[" + std::to_string(candidateIndices.back().first) +
-                                    "," + std::to_string(candidateIndices.back().second) + "]";
-        if (candidateIndices.back().second == -1) // Degree cluster branching
+        if (isDuplicate[c])
+        {
+            duplicateScores.push_back(candidates[c].score);
+            continue;
+        }
+        candidates[nbKept++] = candidates[c];
+    }
+    candidates.resize(nbKept);
+}
+
+// The edge candidates are reordered by the learned scorer: they take the scores of the edge candidates in the order
+// of the model, so the ranking between the families is kept. The edges with a reliable pseudo-cost keep their
+// estimate
+void cvrp_joao::UserBranchingFunctor::applyBranchingScorer()
+{
+    scorerPositions.clear();
+    scorerEdges.clear();
+    for (int c = 0; c < (int) candidates.size(); c++)
+        if (candidates[c].family == BranchingFamily::CostlyEdge && !candidates[c].reliable)
         {
-            branchingName = "DegCluster " + std::to_string(candidateIndices.back().first);
-            constMultiplier = 0.5;
+            scorerPositions.push_back(c);
+            scorerEdges.emplace_back(candidates[c].first, candidates[c].second);
         }
-        // std::cout << branchingName << std::endl;
-        BcConstr bcConstr = userBranching(constrCount++);
-        for (auto pair = candidateIndices.begin(); pair != std::prev(candidateIndices.end()); ++pair)
-            bcConstr += constMultiplier * xVar[pair->first][pair->second];
-        /// second parameter here is an unique string which characterizes the branching constraint
-        /// this string is used to keep the branching history
-        returnBrConstrList.emplace_back(bcConstr, branchingName);
+    int nbEdges = (int) scorerPositions.size();
+    if (nbEdges == 0)
+        return;
+
+    branchingFeatures.scoreEdges(data, scorerEdges, lpSolution, xReducedCosts, xNbColumns, scorerScores);
+    scorerHeuristicScores.clear();
+    for (const auto & c : scorerPositions)
+        scorerHeuristicScores.push_back(candidates[c].score);
+    std::sort(scorerHeuristicScores.begin(), scorerHeuristicScores.end(), std::greater<double>());
+    scorerOrder.resize(nbEdges);
+    std::iota(scorerOrder.begin(), scorerOrder.end(), 0);
+    std::sort(scorerOrder.begin(), scorerOrder.end(), [this](int a, int b) {
+        return (scorerScores[a] != scorerScores[b]) ? scorerScores[a] > scorerScores[b] : a < b;
+    });
+
+    for (int k = 0; k < nbEdges; k++)
+        candidates[scorerPositions[scorerOrder[k]]].score = scorerHeuristicScores[k];
+    if (params.branchingVerbose())
+        std::cout << "Branching candidates reordered by the learned scorer: " << nbEdges << " edge(s)" << std::endl;
+}
+
+void cvrp_joao::UserBranchingFunctor::selectCandidates(const int & candListMaxSize)
+{
+    for (int c = 0; c < (int) candidates.size(); c++)
+        candidates[c].order = c;
+    /// With a pseudo-cost history, the candidates are ranked by the estimated gains of their branches
+    bool usePseudoCosts = (params.pseudoCostReliability() > 0) && !pseudoCosts.empty();
+    if (usePseudoCosts)
+        for (auto & candidate : candidates)
+        {
+            auto id = pseudoCosts.find(getCandidateSignature(candidate));
+            candidate.reliable = pseudoCosts.isReliable(id);
+            candidate.score = familyPriority(candidate.family) * pseudoCosts.score(id, candidate.fractionalPart);
+        }
+    if (params.enableBranchingFeatures() && branchingFeatures.hasScorer())
+        applyBranchingScorer();
+
+    auto listSize = std::max(0, std::min(candListMaxSize, (int) candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + listSize, candidates.end(),
+                      [](const BranchingCandidate & a, const BranchingCandidate & b) {
+                          return (a.score != b.score) ? a.score > b.score : a.order < b.order;
+                      });
+
+    /// With pruning, the estimate of a reliable candidate is trusted, so the candidates ranked after the first
+    /// reliable one are not evaluated by strong branching (and if it is the first one, there is no strong branching
+    /// at all). The child bounds are inferred (see updatePseudoCosts), so it is opt-in
+    if (usePseudoCosts && params.pseudoCostPruning())
+        for (int c = 0; c < listSize; c++)
+            if (candidates[c].reliable)
+            {
+                if (params.branchingVerbose())
+                    std::cout << "Branching candidates pruned by a reliable pseudo-cost: " << listSize - c - 1 << std::endl;
+                listSize = c + 1;
+                break;
+            }
+
+    // Usefulness of the fractional clusters: the kept candidates are the ones evaluated by strong branching
+    for (int c = 0; c < (int) candidates.size(); c++)
+    {
+        const auto & candidate = candidates[c];
+        if (candidate.family != BranchingFamily::FractionalCluster)
+            continue;
+        fractionalClusters.recordCandidate(candidate.positions.first, c < listSize);
+        if (candidate.positions.second != -1)
+            fractionalClusters.recordCandidate(candidate.positions.second, c < listSize);
     }
 
-    return true;
+    // A duplicate would have been evaluated by strong branching if it was not worse than the last kept candidate
+    int nbSaved = 0;
+    for (const auto & score : duplicateScores)
+        if (listSize == (int) candidates.size() || (listSize > 0 && score >= candidates[listSize - 1].score))
+            nbSaved++;
+    nbSavedSBEvaluations += std::min(nbSaved, listSize);
+
+    if (params.branchingVerbose())
+        std::cout << "Branching candidates kept: " << listSize << " of " << candidates.size() << " ("
+                  << duplicateScores.size() << " duplicate(s) removed; saved SB evaluations = " << nbSavedSBEvaluations
+                  << ")" << std::endl;
+    candidates.resize(listSize);
 }
 
-bool cvrp_joao::UserBranchingFunctor::branchingOverCutsets(BcBranchingConstrArray &userBranching, BcVarArray &xVar,
-                                                           const std::vector<std::vector<double>> &xSolution,
-                                                           std::list<std::pair<BcConstr, std::string>> &returnBrConstrList) {
-    /// Creating required data structures
-    std::vector<int> demands(data.nbCustomers + 1, 0), edgeTail(1, 0), edgeHead(1, 0);
-    std::vector<double> edgeLPValue(1, 0.0);
-    int nbEdges;
+// ##############################################################################################
+//  Pseudo-costs:
+//  BaPCod does not give the node identities nor the child node bounds to the functor, so they are inferred. The
+//  candidates kept at a node are recorded with the node LP value; when the functor is called again, a record is
+//  assumed to be the parent of the current node if exactly one of its candidate constraints now satisfies one of
+//  its branches, i.e. is at most the floor (down branch) or at least the ceil (up branch) of its recorded value,
+//  and if the current LP value is not below the recorded one (a child bound cannot be lower than its parent's)
+// ##############################################################################################
 
-    /// Filling the datastructures
-    /// the CVRPSEP default assume that the depot is numbered nbCustomers + 1
-    /// Only information on those edges e with LP value x_e > 0 should be passed
-    for (int custId = 1; custId <= data.nbCustomers; ++custId)
-        demands[custId] = data.customers[custId].demand;
-
-    for (int firstNodeId = 0; firstNodeId < data.nbCustomers; firstNodeId++) {
-        for (int secondNodeId = firstNodeId + 1; secondNodeId <= data.nbCustomers; secondNodeId++) {
-            if (xSolution[firstNodeId][secondNodeId] > 0) {
-                auto custId = (firstNodeId == 0) ? data.nbCustomers + 1 : firstNodeId;
-                edgeTail.push_back(custId);
-                edgeHead.push_back(secondNodeId);
-                edgeLPValue.push_back(xSolution[firstNodeId][secondNodeId]);
+double cvrp_joao::UserBranchingFunctor::getSignatureValue(const std::vector<int> & signature,
+                                                         const SparseXSolution & xSolution)
+{
+    auto nbNodes = data.nbCustomers + 1;
+    signatureSide.resize(nbNodes, 0);
+    for (int k = 1; k < (int) signature.size(); k++)
+        signatureSide[signature[k] % nbNodes] = (signature[k] < nbNodes) ? 1 : 2;
+
+    double value = 0.0;
+    for (int e = 0; e < xSolution.nbEdges(); e++)
+    {
+        auto firstSide = signatureSide[xSolution.edgeFirstNode(e)], secondSide = signatureSide[xSolution.edgeSecondNode(e)];
+        if (signature.front() == DegreeTag ? firstSide != secondSide : firstSide + secondSide == 3)
+            value += xSolution.edgeLPValue(e);
+    }
+    if (signature.front() == DegreeTag)
+        value /= 2.0;
+
+    for (int k = 1; k < (int) signature.size(); k++)
+        signatureSide[signature[k] % nbNodes] = 0;
+    return value;
+}
+
+void cvrp_joao::UserBranchingFunctor::updatePseudoCosts(double lpValue, const SparseXSolution & xSolution)
+{
+    const double epsilon = 1e-6;
+    for (int k = pendingBranchings.size() - 1; k >= 0; k--)
+    {
+        auto & pending = pendingBranchings[k];
+        if (lpValue < pending.lpValue - epsilon)
+            continue;
+
+        int match = -1, nbMatches = 0;
+        bool up = false;
+        for (int c = 0; c < pending.nbCandidates; c++)
+        {
+            if (pending.branched != -1 && pending.branched != c)
+                continue;
+
+            auto value = getSignatureValue(getPendingSignature(pending, c), xSolution);
+            auto floorValue = std::floor(pending.values[c]);
+            if (value <= floorValue + epsilon || value >= floorValue + 1.0 - epsilon)
+            {
+                match = c;
+                up = value >= floorValue + 1.0 - epsilon;
+                nbMatches++;
             }
         }
-    }
-    nbEdges = (int) edgeTail.size() - 1;
-
-    Cutsets cutsets(data.nbCustomers, data.veh_capacity, demands, nbEdges,
-            edgeTail, edgeHead, edgeLPValue,3.0, data.nbCustomers, true);
-
-    /// return a unordered_map<"HashName", pair<vector<int> cutset, double cutset rhs>>
-    auto myCutsets = cutsets.getCutsets();
-    // Check if the name exists in the map and/or if the cutset cluster exist in CB cluster list
-    std::unordered_map<std::string, std::pair<std::vector<int>, double>> updatedCutsets;
-    for (auto & pair : myCutsets) {
-        auto & stringId = pair.first; // cutset string id
-
-        size_t position;
-        auto it = cutsetsIdMap.find(stringId);
-        if (it != cutsetsIdMap.end()) {
-            // Name exists in the map, print its position
-            position = it->second;
-        } else {
-            // Name does not exist, add it to the map with the next position
-            position = cutsetsIdMap.size();
-            cutsetsIdMap[stringId] = position;
+        if (nbMatches != 1 || (up ? pending.upSeen : pending.downSeen))
+            continue;
+
+        auto change = up ? std::ceil(pending.values[match]) - pending.values[match]
+                         : pending.values[match] - std::floor(pending.values[match]);
+        pseudoCosts.update(getPendingSignature(pending, match), up, std::max(0.0, lpValue - pending.lpValue) / change);
+        if (pending.branched == -1)
+        {
+            pseudoCosts.recordBranched(getPendingSignature(pending, match));
+            /// The usefulness of the fractional clusters also counts the nodes branched on them
+            for (auto clustId : {pending.fracClusters[match].first, pending.fracClusters[match].second})
+                if (clustId != -1)
+                    fractionalClusters.recordBranched(clustId);
         }
+        if (pending.edges[match].first != -1)
+            branchingFeatures.recordOutcome(pending.nodeId, pending.edges[match].first, pending.edges[match].second, up,
+                                            std::max(0.0, lpValue - pending.lpValue));
+        if (pending.depth != -1)
+            nodeDepth = pending.depth + 1;
+        pending.branched = match;
+        (up ? pending.upSeen : pending.downSeen) = true;
+        if (pending.upSeen && pending.downSeen)
+            pendingBranchings.erase(k);
+        break;
+    }
+}
 
-        // Checking if the cutset cluster exist in CB cluster list
-        bool flag = false;
-        if (params.enableClusterBranching())
-            for (const auto & cluster : clusters.clusters)
-                if (pair.second.first == cluster.second) {
-                    flag = true;
-                    break;
-                }
-
-        // Update the key in the new map
-        if (!flag) updatedCutsets[std::to_string(position)] = std::move(pair.second);
+void cvrp_joao::UserBranchingFunctor::recordBranching(double lpValue)
+{
+    auto & pending = pendingBranchings.next(nodeId, nodeDepth, lpValue);
+    for (const auto & candidate : candidates)
+    {
+        /// The route cluster degrees are not over a cut or between two sets, so they are not recorded
+        if (candidate.family == BranchingFamily::RouteCluster)
+            continue;
+        auto edge = (candidate.family == BranchingFamily::CostlyEdge)
+                    ? std::make_pair(candidate.first, candidate.second) : std::make_pair(-1, -1);
+        auto fracClusterIds = (candidate.family == BranchingFamily::FractionalCluster)
+                              ? std::make_pair(candidate.first, candidate.second) : std::make_pair(-1, -1);
+        pending.addCandidate(signatureArena.data() + candidate.signatureBegin,
+                             signatureArena.data() + candidate.signatureEnd, candidate.value, edge, fracClusterIds);
     }
-    myCutsets = std::move(updatedCutsets);
-    Cutsets::printCutsets(myCutsets);
+    if (pending.nbCandidates == 0)
+        return;
+    /// With a single candidate, there is no strong branching
+    if (pending.nbCandidates > 1)
+        for (int c = 0; c < pending.nbCandidates; c++)
+            pseudoCosts.recordEvaluation(getPendingSignature(pending, c));
+
+    pendingBranchings.push();
+}
 
-    double threshold = 0.1; /// should be between 0.0 and 0.5
-    /// In indices: the last pair identifies the branching
-    std::vector<std::vector<std::pair<int, int>>> indices;
-    /// In candidates: pair.first = pos. in indices, pair.second = fract. sol. part
-    std::vector<std::pair<int, double>> candidates;
-    /// Branching over cutset degree
-    for (const auto & cutset : myCutsets) {
-        double totalXvalueDeg = cutset.second.second; /// Cutset RHS value
-        totalXvalueDeg /= 2.0; /// we should divide by 2 to have the number of paths
-        double fractionalPart = totalXvalueDeg - (int) totalXvalueDeg;
-        if (fractionalPart > threshold && fractionalPart < 1 - threshold) {
-            std::string branchingName = "Cutset[" + cutset.first + "]";
-            BcConstr bcConstr = userBranching(constrCount++); // Creating branching constraint
+void cvrp_joao::UserBranchingFunctor::materializeCandidate(const BranchingCandidate & candidate,
+                                                           BcBranchingConstrArray & userBranching, BcVarArray & xVar,
+                                                           std::list<std::pair<BcConstr, std::string>> & returnBrConstrList)
+{
+    char branchingName[64];
+    BcConstr bcConstr = userBranching(constrCount++);
+    switch (candidate.family)
+    {
+        case BranchingFamily::DefaultCluster:
+        case BranchingFamily::FractionalCluster:
+        {
+            bool isDefault = (candidate.family == BranchingFamily::DefaultCluster);
+            auto & store = isDefault ? defaultClusterEdges : fracClusterEdges;
+            const auto & first = isDefault ? clusters.clusters[candidate.positions.first]
+                                           : fractionalClusters.clusters[candidate.positions.first];
+            double constMultiplier = 1.0;
+            ClusterEdgeStore::Span span{};
+            if (candidate.second == -1) // Degree cluster branching
+            {
+                snprintf(branchingName, sizeof(branchingName), "DegCluster %d", candidate.first);
+                constMultiplier = 0.5;
+                /// The constraint is over all edges of the cut, including those with null LP value
+                if (isDefault)
+                    span = store.boundary(first.first, first.second, data.nbCustomers + 1,
+                                          [&](int i) { return clusters.customerInCluster(i, first.first); });
+                else
+                    span = store.boundary(first.first, first.second, data.nbCustomers + 1,
+                                          [&](int i) { return fractionalClusters.customerInCluster(i, first.first); });
+            }
+            else
+            {
+                snprintf(branchingName, sizeof(branchingName), "AggClusters[%d,%d]", candidate.first, candidate.second);
+                const auto & second = isDefault ? clusters.clusters[candidate.positions.second]
+                                                : fractionalClusters.clusters[candidate.positions.second];
+                span = store.between(first.first, first.second, second.first, second.second);
+            }
+            for (int e = span.begin; e < span.end; ++e)
+            {
+                const auto & edge = store.edge(e);
+                bcConstr += constMultiplier * xVar[edge.first][edge.second];
+            }
+            break;
+        }
+        case BranchingFamily::RouteCluster:
+        {
+            snprintf(branchingName, sizeof(branchingName), "DegRouteCluster %d", candidate.first);
+            const auto & firstCluster = clusters.routeClusters[candidate.positions.first];
+            for (const auto & secondCluster: clusters.routeClusters)
+            {
+                int secondClusterId = clusters.getVertexClusterId(secondCluster.front(), true);
+                if (candidate.first == secondClusterId)
+                    continue;
 
-            std::vector<int> set = cutset.second.first;
+                for (const int & i: firstCluster)
+                    for (const int & j: secondCluster)
+                        bcConstr += 0.5 * xVar[std::min(i, j)][std::max(i, j)];
+            }
+            break;
+        }
+        case BranchingFamily::Cutset:
+        {
+            snprintf(branchingName, sizeof(branchingName), "Cutset[%d]", candidate.first);
+            /// All edges of delta(S), including those with null LP value; the membership of S is marked in a
+            /// bitset reused between cutsets (CVRPSEP sets only contain customers, the depot is nbCustomers + 1)
+            const std::vector<int> & set = *candidate.set;
+            for (const int & i: set)
+                cutsetMembers.set(i);
             for (const int & i: set) {
-                for (int j = 1; j <= data.nbCustomers + 1; j++) {
-                    if (std::find(set.begin(), set.end(), j) == set.end()) {
-                        int firstNodeId, secondNodeId;
-                        if ((i == data.nbCustomers + 1) || (j == data.nbCustomers + 1)) {
-                            firstNodeId = 0;
-                            secondNodeId = std::min(i, j);
-                        } else {
-                            firstNodeId = std::min(i, j);
-                            secondNodeId = std::max(i, j);
-                        }
-                        bcConstr += 0.5 * xVar[firstNodeId][secondNodeId];
-                    }
-                }
+                for (int j = 1; j <= data.nbCustomers; j++)
+                    if (!cutsetMembers.test(j))
+                        bcConstr += 0.5 * xVar[std::min(i, j)][std::max(i, j)];
+                bcConstr += 0.5 * xVar[0][i];
             }
-            /// second parameter here is an unique string which characterizes the branching constraint
-            /// this string is used to keep the branching history
-            returnBrConstrList.emplace_back(bcConstr, branchingName);
+            for (const int & i: set)
+                cutsetMembers.reset(i);
+            break;
+        }
+        case BranchingFamily::CostlyEdge:
+        {
+            snprintf(branchingName, sizeof(branchingName), "EDGE[%d,%d]", candidate.first, candidate.second);
+            bcConstr += xVar[candidate.first][candidate.second];
+            break;
         }
     }
-    return true;
+    // std::cout << branchingName << std::endl;
+    /// second parameter here is an unique string which characterizes the branching constraint
+    /// this string is used to keep the branching history
+    returnBrConstrList.emplace_back(bcConstr, std::string(branchingName));
 }
 
-bool cvrp_joao::UserBranchingFunctor::computeMinCut(BcVarArray & xVar, const std::vector<std::vector<double>> & xSolution)
+bool cvrp_joao::UserBranchingFunctor::computeMinCut(BcVarArray & xVar, const SparseXSolution & xSolution)
 {
     std::cout << "Min cut evaluation" << std::endl;
-    ds::MinimumCut minimumCut(xSolution, data.nbCustomers);
+    xSolution.toDense(xDenseSolution);
+    minimumCut.compute(xDenseSolution, data.nbCustomers);
     std::cout << minimumCut.nbMinCuts() << " min cut(s) with value = " << minimumCut.value() << std::endl;
     minimumCut.printCuts();
 
@@ -507,48 +932,40 @@ bool cvrp_joao::UserBranchingFunctor::computeMinCut(BcVarArray & xVar, const std
 //  Second: The list of branching candidates is defined with the K most costly edges in that interval
 // ##############################################################################################
 
-bool cvrp_joao::UserBranchingFunctor::branchingOverCostlyEdges(BcBranchingConstrArray & userBranching, BcVarArray & xVar,
-                              const std::vector<std::vector<double> > & xSolution,
-                              std::list<std::pair<BcConstr, std::string> > & returnBrConstrList,
-                              const int & candListMaxSize)
+void cvrp_joao::UserBranchingFunctor::branchingOverCostlyEdges(const SparseXSolution & xSolution)
 {
     double minFracValue = 0.2;
     double maxFracValue = 0.8;
-    /// In candidates: pair.first = pair {i,j}, pair.second = edge {i,j} cost
-    std::vector<std::pair<std::pair<int, int>, double>> candidates;
+    auto nbCandidates = candidates.size();
 
-    for (int firstNodeId = 0; firstNodeId < data.nbCustomers; firstNodeId++)
+    for (int e = 0; e < xSolution.nbEdges(); e++)
     {
-        for (int secondNodeId = firstNodeId + 1; secondNodeId <= data.nbCustomers; secondNodeId++)
+        if ((xSolution.edgeLPValue(e) >= minFracValue) && (xSolution.edgeLPValue(e) <= maxFracValue))
         {
-            if ((xSolution[firstNodeId][secondNodeId] >= minFracValue) &&
-                (xSolution[firstNodeId][secondNodeId] <= maxFracValue))
-            {
-                auto cost = (firstNodeId != 0) ? data.getCustToCustDistance(firstNodeId, secondNodeId)
-                                               : data.getDepotToCustDistance(secondNodeId);
-                candidates.emplace_back(std::make_pair(firstNodeId, secondNodeId), cost);
-            }
+            auto firstNodeId = xSolution.edgeFirstNode(e), secondNodeId = xSolution.edgeSecondNode(e);
+            auto & candidate = addCandidate(BranchingFamily::CostlyEdge, firstNodeId, secondNodeId,
+                                            xSolution.edgeLPValue(e));
+            candidate.cost = data.getNodeToNodeDistance(firstNodeId, secondNodeId);
         }
     }
 
-    // Sort candidates by most fractional
-    auto listSize = std::min(candListMaxSize, (int) candidates.size());
-    std::cout << "Branching candidates list size: " << listSize << std::endl;
-    std::partial_sort(candidates.begin(), candidates.begin() + listSize, candidates.end(), costSort);
-    // To add the candidates in the list
-    for (int i = 0; i < listSize; i++)
-    {
-        std::string branchingName = "EDGE[" + std::to_string(candidates[i].first.first) +
-                                    "," + std::to_string(candidates[i].first.second) + "]";
-        // std::cout << branchingName << std::endl;
-        BcConstr bcConstr = userBranching(constrCount++);
-        bcConstr += xVar[candidates[i].first.first][candidates[i].first.second];
-        /// second parameter here is an unique string which characterizes the branching constraint
-        /// this string is used to keep the branching history
-        returnBrConstrList.emplace_back(bcConstr, branchingName);
-    }
-
-    return true;
+    /// Within the family, the edges are ranked by cost only (most costly first), as in the original rule; their
+    /// fractionality only places the family in the ranking with the other families. So the edges are sorted by cost
+    /// and take the fractionality scores in decreasing order
+    auto firstEdge = candidates.begin() + nbCandidates;
+    familyScores.clear();
+    for (auto it = firstEdge; it != candidates.end(); ++it)
+        familyScores.push_back(it->score);
+    std::sort(familyScores.begin(), familyScores.end(), std::greater<double>());
+    std::sort(firstEdge, candidates.end(), [](const BranchingCandidate & a, const BranchingCandidate & b) {
+        if (a.cost != b.cost)
+            return a.cost > b.cost;
+        return std::make_pair(a.first, a.second) < std::make_pair(b.first, b.second);
+    });
+    for (size_t k = 0; k < familyScores.size(); k++)
+        firstEdge[k].score = familyScores[k];
+
+    std::cout << "Branching candidates list size: " << candidates.size() - nbCandidates << std::endl;
 }
 
 // ##############################################################################################
@@ -11,59 +11,211 @@
 #include <algorithm>
 #include <cfloat>
 
+int cvrp_joao::EdgeFeatureStore::find(uint64_t id) const
+{
+    if (slots.empty())
+        return -1;
+    for (auto s = hash(id) & mask; slots[s] != 0; s = (s + 1) & mask)
+        if (edgeIds[slots[s] - 1] == id)
+            return slots[s] - 1;
+    return -1;
+}
+
+std::pair<int, bool> cvrp_joao::EdgeFeatureStore::insert(uint64_t id)
+{
+    // The load factor is kept below 1/2
+    if (2 * (edgeIds.size() + 1) > slots.size())
+        grow();
+    auto s = hash(id) & mask;
+    for (; slots[s] != 0; s = (s + 1) & mask)
+        if (edgeIds[slots[s] - 1] == id)
+            return std::make_pair(slots[s] - 1, false);
+
+    edgeIds.push_back(id);
+    slots[s] = (int) edgeIds.size();
+    for (auto * column : {&fracValue, &avgFracValue, &cost, &reducedCost, &distDepot, &distConvexHull,
+                          &distNearestNeighbor, &sumDemandsEndpoints, &sumDemandsNeighbors})
+        column->push_back(0.0);
+    for (auto * column : {&nbBranchingOn, &nbRoutesIn, &nbSBEval})
+        column->push_back(0);
+    lastEvalNode.push_back(-1);
+    return std::make_pair((int) edgeIds.size() - 1, true);
+}
+
+uint64_t cvrp_joao::EdgeFeatureStore::hash(uint64_t id)
+{
+    // splitmix64 finalizer
+    id ^= id >> 30;
+    id *= 0xbf58476d1ce4e5b9ULL;
+    id ^= id >> 27;
+    id *= 0x94d049bb133111ebULL;
+    id ^= id >> 31;
+    return id;
+}
+
+void cvrp_joao::EdgeFeatureStore::grow()
+{
+    slots.assign(std::max((size_t) 64, 2 * slots.size()), 0);
+    mask = slots.size() - 1;
+    for (int r = 0; r < (int) edgeIds.size(); r++)
+    {
+        auto s = hash(edgeIds[r]) & mask;
+        while (slots[s] != 0)
+            s = (s + 1) & mask;
+        slots[s] = r + 1;
+    }
+}
+
 void cvrp_joao::BranchingFeatures::loadBranchingFeatures(const Data & data, int nbCandidates_)
 {
     // Number of candidates of the SB 1º phase
     nbCandidates = nbCandidates_;
-    // Identifying the two neighbors (the nearest) of each customer
-    neighbors = std::vector<std::pair<int, int>> (data.nbCustomers + 1, std::make_pair(-1, -1));
-    for (int i = 0; i <= data.nbCustomers; i++) {
+    computeNearestNeighbors(data);
+
+    ConvexHull hull(data);
+    convexHull = hull.hull;
+    std::cout << "Convex Hull:";
+    for (auto & p : convexHull)
+        std::cout << " " << p.first << " (" << p.second.first << "," << p.second.second << ")" ;
+    std::cout << std::endl;
+    computeHullDistances(data);
+}
+
+// Identifying the two neighbors (the nearest) of each node. The nodes are bucketed in a uniform grid of about two
+// nodes per cell, and the rings of cells around a node are scanned until no unseen node can be nearer than the
+// second neighbor. Ties are broken by the smallest id, as in a scan of all nodes
+void cvrp_joao::BranchingFeatures::computeNearestNeighbors(const Data & data)
+{
+    int nbNodes = data.nbCustomers + 1;
+    std::vector<double> xCoord(nbNodes), yCoord(nbNodes);
+    xCoord[0] = data.depot_x;
+    yCoord[0] = data.depot_y;
+    for (int i = 1; i < nbNodes; i++)
+    {
+        xCoord[i] = data.customers[i].x;
+        yCoord[i] = data.customers[i].y;
+    }
+    double minX = *std::min_element(xCoord.begin(), xCoord.end()), maxX = *std::max_element(xCoord.begin(), xCoord.end());
+    double minY = *std::min_element(yCoord.begin(), yCoord.end()), maxY = *std::max_element(yCoord.begin(), yCoord.end());
+    int gridSize = std::max(1, (int) std::ceil(std::sqrt(nbNodes / 2.0)));
+    double cellSize = std::max(std::max(maxX - minX, maxY - minY) / gridSize, 1e-9);
+    auto cellOf = [&](double coord, double minCoord) {
+        return std::min(gridSize - 1, (int) ((coord - minCoord) / cellSize));
+    };
+
+    // Nodes of each cell (CSR)
+    std::vector<int> cellStart(gridSize * gridSize + 1, 0), cellNodes(nbNodes), nodeCell(nbNodes);
+    for (int i = 0; i < nbNodes; i++)
+    {
+        nodeCell[i] = cellOf(yCoord[i], minY) * gridSize + cellOf(xCoord[i], minX);
+        cellStart[nodeCell[i] + 1]++;
+    }
+    for (int c = 0; c < gridSize * gridSize; c++)
+        cellStart[c + 1] += cellStart[c];
+    std::vector<int> fillPos(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < nbNodes; i++)
+        cellNodes[fillPos[nodeCell[i]]++] = i;
+
+    neighbors = std::vector<std::pair<int, int>> (nbNodes, std::make_pair(-1, -1));
+    for (int i = 0; i < nbNodes; i++) {
         double dist1 = FLT_MAX, dist2 = FLT_MAX;
         auto firstNeighbor = -1, secondNeighbor = -1;
-        for (int j = 0; j <= data.nbCustomers; j++) {
+        auto visit = [&](int j) {
             if (i == j)
-                continue;
+                return;
 
-            auto distAux = (i == 0) ? data.getDepotToCustDistance(j) : data.getCustToCustDistance(i, j);
-            if (distAux < dist1)
+            auto distAux = data.getNodeToNodeDistance(i, j);
+            if (distAux < dist1 || (distAux == dist1 && j < firstNeighbor))
             {
                 dist2 = dist1;
                 secondNeighbor = firstNeighbor;
                 dist1 = distAux;
                 firstNeighbor = j;
             }
-            else if (distAux < dist2)
+            else if (distAux < dist2 || (distAux == dist2 && j < secondNeighbor))
             {
                 dist2 = distAux;
                 secondNeighbor = j;
             }
+        };
+
+        int cellX = nodeCell[i] % gridSize, cellY = nodeCell[i] / gridSize;
+        for (int ring = 0; ring < gridSize; ring++)
+        {
+            for (int cy = std::max(0, cellY - ring); cy <= std::min(gridSize - 1, cellY + ring); cy++)
+            {
+                bool borderRow = (cy == cellY - ring || cy == cellY + ring);
+                for (int cx = std::max(0, cellX - ring); cx <= std::min(gridSize - 1, cellX + ring); cx++)
+                {
+                    if (!borderRow && cx != cellX - ring && cx != cellX + ring)
+                        continue;
+                    int c = cy * gridSize + cx;
+                    for (int k = cellStart[c]; k < cellStart[c + 1]; k++)
+                        visit(cellNodes[k]);
+                }
+            }
+            // The nodes outside the scanned rings are at distance at least ring * cellSize, and the distances are
+            // at most rounded to the closest integer
+            double lowerBound = ring * cellSize;
+            if (data.roundType == Data::ROUND_CLOSEST)
+                lowerBound = std::round(lowerBound) - 1.0;
+            if (secondNeighbor != -1 && lowerBound > dist2)
+                break;
         }
         neighbors[i] = std::make_pair(firstNeighbor, secondNeighbor);
     }
+}
 
-    ConvexHull hull(data);
-    convexHull = hull.hull;
-    std::cout << "Convex Hull:";
-    for (auto & p : convexHull)
-        std::cout << " " << p.first << " (" << p.second.first << "," << p.second.second << ")" ;
-    std::cout << std::endl;
+// Distance of each node to the nearest facet line of the convex hull. The facets are normalized once as
+// a * x + b * y + c = 0 with a^2 + b^2 = 1, so each facet is a branch-free pass over the coordinate arrays
+void cvrp_joao::BranchingFeatures::computeHullDistances(const Data & data)
+{
+    int nbNodes = data.nbCustomers + 1;
+    std::vector<double> xCoord(nbNodes), yCoord(nbNodes);
+    xCoord[0] = data.depot_x;
+    yCoord[0] = data.depot_y;
+    for (int i = 1; i < nbNodes; i++)
+    {
+        xCoord[i] = data.customers[i].x;
+        yCoord[i] = data.customers[i].y;
+    }
+
+    hullDistance.assign(nbNodes, convexHull.size() < 2 ? 0.0 : 1e8);
+    for (size_t f = 0; f < convexHull.size() && convexHull.size() >= 2; f++)
+    {
+        const auto & p1 = convexHull[f].second;
+        const auto & p2 = convexHull[(f + 1) % convexHull.size()].second;
+        double dx = p2.first - p1.first, dy = p2.second - p1.second;
+        double length = std::sqrt(dx * dx + dy * dy);
+        double a = dy / length, b = -dx / length, c = (dx * p1.second - dy * p1.first) / length;
+        const double * xs = xCoord.data();
+        const double * ys = yCoord.data();
+        double * dist = hullDistance.data();
+        for (int i = 0; i < nbNodes; i++)
+            dist[i] = std::min(dist[i], std::abs(a * xs[i] + b * ys[i] + c));
+    }
 }
 
-void cvrp_joao::BranchingFeatures::updateBranchingFeatures(const Data & data,
-                                                     const std::vector<std::vector<double>> & xSolution,
+void cvrp_joao::BranchingFeatures::updateBranchingFeatures(const Data & data, int nodeId, int depth,
+                                                     const SparseXSolution & xSolution,
                                                      const std::vector<std::vector<double> > & xReducedCost,
                                                      const std::vector<std::vector<int> > & xNbColumns)
 {
-    std::vector<std::pair<std::pair<int, int>, double>> candidates;
-    for (int i = 0; i < xSolution.size(); i++) {
-        for (int j = i + 1; j < xSolution.size(); j++) {
-            double fractionalPart = xSolution[i][j] - (int) xSolution[i][j];
-            candidates.emplace_back(std::make_pair(i,j), fractionalPart);
-        }
+    updateNeighborsDemand(data, xSolution);
+    lastNodeId = nodeId;
+
+    // Only the fractional edges are candidates (the positive edges are those of the sparse solution)
+    double integralityTolerance = 1e-6;
+    candidates.clear();
+    for (int e = 0; e < xSolution.nbEdges(); e++) {
+        double fractionalPart = xSolution.edgeLPValue(e) - (int) xSolution.edgeLPValue(e);
+        if (fractionalPart < integralityTolerance || fractionalPart > 1.0 - integralityTolerance)
+            continue;
+        candidates.emplace_back(std::make_pair(xSolution.edgeFirstNode(e), xSolution.edgeSecondNode(e)), fractionalPart);
     }
 
     // Sort the first nbCandidates (SB list size) candidates
-    int sz = std::min((int) (1.25 * nbCandidates), (int) (xSolution.size() * (xSolution.size() - 1) / 2));
+    int sz = std::min((int) (1.25 * nbCandidates), (int) candidates.size());
     std::partial_sort(candidates.begin(), candidates.begin() + sz, candidates.end(), sortRule);
     auto count = 1;
     for (auto & cand : candidates)
@@ -73,85 +225,128 @@ void cvrp_joao::BranchingFeatures::updateBranchingFeatures(const Data & data,
         count++;
 
         auto firstNode = cand.first.first, secondNode = cand.first.second;
-        std::string name = "EDGE[" + std::to_string(firstNode) + "," + std::to_string(secondNode) + "]";
+        auto & f = edgeFeatures;
+        int r = updateEdgeFeatures(data, firstNode, secondNode, xSolution, xReducedCost, xNbColumns);
+        f.avgFracValue[r] = (f.nbSBEval[r] * f.avgFracValue[r] + f.fracValue[r]) / (f.nbSBEval[r] + 1);
+        f.nbSBEval[r] += 1;
+        f.lastEvalNode[r] = nodeId;
 
-        auto it = edgeFeatures.find(name);
-        if (it != edgeFeatures.end()) // if exists in list, update Features
-        {
-            it->second.fracValue = xSolution[firstNode][secondNode];
-            it->second.avgFracValue = (it->second.nbSBEval * it->second.avgFracValue + it->second.fracValue) /
-                                      (it->second.nbSBEval + 1);
-            it->second.nbSBEval += 1;
-            it->second.nbRoutesIn = xNbColumns[firstNode][secondNode];
-            it->second.reducedCost = xReducedCost[firstNode][secondNode];
-            it->second.sumDemandsNeighbors = getSumDemandsNeighbors(firstNode, secondNode, data, xSolution);
-        }
-        else // insert in the list
-        {
-            auto cost = (firstNode == 0) ? data.getDepotToCustDistance(secondNode) :
-                                           data.getCustToCustDistance(firstNode, secondNode);
-
-            auto sumDemands = data.customers[firstNode].demand + data.customers[secondNode].demand;
-            auto sumDemandsNeighbors = getSumDemandsNeighbors(firstNode, secondNode, data, xSolution);
-
-            auto distDepotToFirstNode = (firstNode == 0) ? 0.0 : data.getDepotToCustDistance(firstNode);
-            auto distDepot = std::min(distDepotToFirstNode, data.getDepotToCustDistance(secondNode));
-
-            double coordFN_x, coordFN_y;
-            auto neighbor1 = (neighbors[firstNode].first != secondNode) ? neighbors[firstNode].first : neighbors[firstNode].second;
-            auto neighbor2 = (neighbors[secondNode].first != firstNode) ? neighbors[secondNode].first : neighbors[secondNode].second;
-            auto distNearest = (neighbor2 == 0) ? data.getDepotToCustDistance(secondNode) : data.getCustToCustDistance(secondNode, neighbor2);
-            if (firstNode == 0) {
-                coordFN_x = data.depot_x;
-                coordFN_y = data.depot_y;
-                distNearest = std::min(distNearest, data.getDepotToCustDistance(neighbor1));
-            } else if (neighbor1 == 0) {
-                coordFN_x = data.customers[firstNode].x;
-                coordFN_y = data.customers[firstNode].y;
-                distNearest = std::min(distNearest, data.getDepotToCustDistance(firstNode));
-            } else {
-                coordFN_x = data.customers[firstNode].x;
-                coordFN_y = data.customers[firstNode].y;
-                distNearest = std::min(distNearest, data.getCustToCustDistance(firstNode, neighbor1));
-            }
-            // get distance to the nearest facet of the convex hull
-            auto coordSN_x = data.customers[secondNode].x, coordSN_y = data.customers[secondNode].y;
-            auto prevConvP_x = convexHull.back().second.first, prevConvP_y = convexHull.back().second.second;
-            double distConvexHull = 1e8;
-            for (auto & i : convexHull)
-            {
-                auto nextConvP_x = i.second.first, nextConvP_y = i.second.second;
-
-                auto distFirstNode = ConvexHull::distancePointToLine(coordFN_x, coordFN_y, prevConvP_x,
-                                                                     prevConvP_y, nextConvP_x, nextConvP_y);
-                auto distSecondNode = ConvexHull::distancePointToLine(coordSN_x, coordSN_y, prevConvP_x,
-                                                                      prevConvP_y, nextConvP_x, nextConvP_y);
-                auto aux = std::min(distFirstNode, distSecondNode);
-                if (aux < distConvexHull)
-                    distConvexHull = aux;
-
-                prevConvP_x = nextConvP_x;
-                prevConvP_y = nextConvP_y;
-            }
+        if (featureLog.isOpen())
+            logFeatures(nodeId, depth, r);
+        else
+            printFeatures(r);
+    }
+}
 
-            EdgeFeatures FeaturesAux = EdgeFeatures(xSolution[firstNode][secondNode], // fracValue
-                                           xSolution[firstNode][secondNode], // avgFracValue
-                                           cost, // cost
-                                           xReducedCost[firstNode][secondNode], // reduced cost
-                                           distDepot, // distDepot
-                                           distConvexHull, // distConvexHull
-                                           distNearest, // distNearestNeighbor
-                                           sumDemands, // sumDemandsEndpoints
-                                           sumDemandsNeighbors, // sumDemandsNeighbors
-                                           0, // nbBranchingOn
-                                           xNbColumns[firstNode][secondNode], // nbRoutesIn
-                                           1); // nbSBEval
-
-            edgeFeatures.emplace(name, FeaturesAux);
-        }
+// Row of the edge in the store, with the features of the current solution. The features that only depend on the
+// instance are computed when the edge is inserted
+int cvrp_joao::BranchingFeatures::updateEdgeFeatures(const Data & data, int firstNode, int secondNode,
+                                                     const SparseXSolution & xSolution,
+                                                     const std::vector<std::vector<double> > & xReducedCost,
+                                                     const std::vector<std::vector<int> > & xNbColumns)
+{
+    auto & f = edgeFeatures;
+    auto inserted = f.insert(EdgeFeatureStore::edgeId(firstNode, secondNode));
+    int r = inserted.first;
+    if (inserted.second) // insert in the list
+    {
+        double values[5];
+        getInstanceFeatures(data, firstNode, secondNode, values);
+        f.cost[r] = values[0];
+        f.distDepot[r] = values[1];
+        f.distConvexHull[r] = values[2];
+        f.distNearestNeighbor[r] = values[3];
+        f.sumDemandsEndpoints[r] = values[4];
+        f.avgFracValue[r] = xSolution.value(firstNode, secondNode);
+        f.nbBranchingOn[r] = 0;
+        f.nbSBEval[r] = 0;
+    }
+    f.fracValue[r] = xSolution.value(firstNode, secondNode);
+    f.reducedCost[r] = xReducedCost[firstNode][secondNode];
+    f.sumDemandsNeighbors[r] = getSumDemandsNeighbors(firstNode, secondNode, data, xSolution);
+    f.nbRoutesIn[r] = xNbColumns[firstNode][secondNode];
+    return r;
+}
+
+// Features that only depend on the instance
+void cvrp_joao::BranchingFeatures::getInstanceFeatures(const Data & data, int firstNode, int secondNode,
+                                                       double * values) const
+{
+    auto distDepotToFirstNode = (firstNode == 0) ? 0.0 : data.getDepotToCustDistance(firstNode);
+    auto neighbor1 = (neighbors[firstNode].first != secondNode) ? neighbors[firstNode].first : neighbors[firstNode].second;
+    auto neighbor2 = (neighbors[secondNode].first != firstNode) ? neighbors[secondNode].first : neighbors[secondNode].second;
+
+    values[0] = data.getNodeToNodeDistance(firstNode, secondNode);
+    values[1] = std::min(distDepotToFirstNode, data.getDepotToCustDistance(secondNode));
+    // get distance to the nearest facet of the convex hull
+    values[2] = std::min(hullDistance[firstNode], hullDistance[secondNode]);
+    values[3] = std::min(data.getNodeToNodeDistance(secondNode, neighbor2),
+                         data.getNodeToNodeDistance(firstNode, neighbor1));
+    values[4] = data.customers[firstNode].demand + data.customers[secondNode].demand;
+}
+
+// Inputs of the scorer for the edge (in the order of BranchingScorer): the features it would have in the log if it
+// were evaluated by strong branching at the current node, so the model sees the distribution it was trained on.
+// The edges evaluated at this node are read from the store; for the others, the evaluation is only simulated
+void cvrp_joao::BranchingFeatures::getScorerFeatures(const Data & data, int firstNode, int secondNode,
+                                                     const SparseXSolution & xSolution,
+                                                     const std::vector<std::vector<double> > & xReducedCost,
+                                                     const std::vector<std::vector<int> > & xNbColumns,
+                                                     double * values) const
+{
+    const auto & f = edgeFeatures;
+    int r = f.find(EdgeFeatureStore::edgeId(firstNode, secondNode));
+    if (r != -1 && f.lastEvalNode[r] == lastNodeId)
+    {
+        double row[BranchingScorer::nbFeatures] = {f.fracValue[r], f.avgFracValue[r], f.cost[r], f.reducedCost[r],
+                                                   f.distDepot[r], f.distConvexHull[r], f.distNearestNeighbor[r],
+                                                   f.sumDemandsEndpoints[r], f.sumDemandsNeighbors[r],
+                                                   (double) f.nbBranchingOn[r], (double) f.nbRoutesIn[r],
+                                                   (double) f.nbSBEval[r]};
+        std::copy(row, row + BranchingScorer::nbFeatures, values);
+        return;
+    }
+
+    double instance[5];
+    if (r != -1)
+    {
+        instance[0] = f.cost[r];
+        instance[1] = f.distDepot[r];
+        instance[2] = f.distConvexHull[r];
+        instance[3] = f.distNearestNeighbor[r];
+        instance[4] = f.sumDemandsEndpoints[r];
+    }
+    else
+        getInstanceFeatures(data, firstNode, secondNode, instance);
+    double fracValue = xSolution.value(firstNode, secondNode);
+    int nbSBEval = (r != -1) ? f.nbSBEval[r] : 0;
+    double avgFracValue = (r != -1) ? (nbSBEval * f.avgFracValue[r] + fracValue) / (nbSBEval + 1) : fracValue;
+    double row[BranchingScorer::nbFeatures] = {fracValue, avgFracValue, instance[0], xReducedCost[firstNode][secondNode],
+                                               instance[1], instance[2], instance[3], instance[4],
+                                               getSumDemandsNeighbors(firstNode, secondNode, data, xSolution),
+                                               (double) ((r != -1) ? f.nbBranchingOn[r] : 0),
+                                               (double) xNbColumns[firstNode][secondNode], (double) (nbSBEval + 1)};
+    std::copy(row, row + BranchingScorer::nbFeatures, values);
+}
 
-        printFeatures(name, edgeFeatures[name]);
+void cvrp_joao::BranchingFeatures::scoreEdges(const Data & data, const std::vector<std::pair<int, int>> & edges,
+                                             const SparseXSolution & xSolution,
+                                             const std::vector<std::vector<double> > & xReducedCost,
+                                             const std::vector<std::vector<int> > & xNbColumns,
+                                             std::vector<double> & scores)
+{
+    /// The inputs of the scorer are column-major: feature k of edge e is at k * nbEdges + e
+    int nbEdges = (int) edges.size();
+    scorerInput.resize((size_t) BranchingScorer::nbFeatures * nbEdges);
+    for (int e = 0; e < nbEdges; e++)
+    {
+        double values[BranchingScorer::nbFeatures];
+        getScorerFeatures(data, edges[e].first, edges[e].second, xSolution, xReducedCost, xNbColumns, values);
+        for (int k = 0; k < BranchingScorer::nbFeatures; k++)
+            scorerInput[(size_t) k * nbEdges + e] = values[k];
     }
+    scores.resize(nbEdges);
+    scorer.predict(scorerInput.data(), nbEdges, scores.data());
 }
 
 bool cvrp_joao::BranchingFeatures::sortRule(const std::pair<std::pair<int, int>, double> & a, const std::pair<std::pair<int, int>, double> & b)
@@ -159,58 +354,83 @@ bool cvrp_joao::BranchingFeatures::sortRule(const std::pair<std::pair<int, int>,
     return std::abs(0.5 - a.second) < std::abs(0.5 - b.second);
 };
 
-void cvrp_joao::BranchingFeatures::printFeatures(const std::string & name, const cvrp_joao::EdgeFeatures & features)
+void cvrp_joao::BranchingFeatures::logFeatures(int nodeId, int depth, int row)
 {
+    const auto & f = edgeFeatures;
+    auto id = f.edgeIds[row];
+    int32_t intValues[FeatureLog::nbFeatureIntColumns] = {nodeId, depth, EdgeFeatureStore::firstNode(id),
+                                                          EdgeFeatureStore::secondNode(id), f.nbBranchingOn[row],
+                                                          f.nbRoutesIn[row], f.nbSBEval[row]};
+    double realValues[FeatureLog::nbFeatureRealColumns] = {f.fracValue[row], f.avgFracValue[row], f.cost[row],
+                                                           f.reducedCost[row], f.distDepot[row], f.distConvexHull[row],
+                                                           f.distNearestNeighbor[row], f.sumDemandsEndpoints[row],
+                                                           f.sumDemandsNeighbors[row]};
+    featureLog.addRow(FeatureLog::FeatureBlock, intValues, realValues);
+}
+
+void cvrp_joao::BranchingFeatures::recordOutcome(int nodeId, int firstNode, int secondNode, bool up, double gain)
+{
+    if (!featureLog.isOpen())
+        return;
+
+    int32_t intValues[FeatureLog::nbOutcomeIntColumns] = {nodeId, firstNode, secondNode, up ? 1 : 0};
+    double realValues[FeatureLog::nbOutcomeRealColumns] = {gain};
+    featureLog.addRow(FeatureLog::OutcomeBlock, intValues, realValues);
+}
+
+void cvrp_joao::BranchingFeatures::printFeatures(int row) const
+{
+    const auto & f = edgeFeatures;
+    auto id = f.edgeIds[row];
+    std::string name = "EDGE[" + std::to_string(EdgeFeatureStore::firstNode(id)) + ","
+                       + std::to_string(EdgeFeatureStore::secondNode(id)) + "]";
     std::cout << std::setprecision(4) << std::fixed
               << "BranchingFeatures: " << std::setw(10) << name
-              << ", fV = " << std::setw(7) << features.fracValue
-              << ", afV = " << std::setw(7) << features.avgFracValue
-              << ", cost = " << std::setw(7) << features.cost
+              << ", fV = " << std::setw(7) << f.fracValue[row]
+              << ", afV = " << std::setw(7) << f.avgFracValue[row]
+              << ", cost = " << std::setw(7) << f.cost[row]
               << std::setprecision(2) << std::fixed
-              << ", redC = " << std::setw(4) << features.reducedCost
-              << ", dD = " << std::setw(4) << features.distDepot
-              << ", dCH = " << std::setw(4) << features.distConvexHull
-              << ", dN = " << std::setw(4) << features.distNearestNeighbor
+              << ", redC = " << std::setw(4) << f.reducedCost[row]
+              << ", dD = " << std::setw(4) << f.distDepot[row]
+              << ", dCH = " << std::setw(4) << f.distConvexHull[row]
+              << ", dN = " << std::setw(4) << f.distNearestNeighbor[row]
               << std::setprecision(1) << std::fixed
-              << ", sDE = " << std::setw(5) << features.sumDemandsEndpoints
-              << ", sDN = " << std::setw(5) << features.sumDemandsNeighbors
+              << ", sDE = " << std::setw(5) << f.sumDemandsEndpoints[row]
+              << ", sDN = " << std::setw(5) << f.sumDemandsNeighbors[row]
               << std::setprecision(0) << std::fixed
-              // << ", nbB = " << std::setw(2) << features.nbBranchingOn
-              << ", nbRI = " << std::setw(2) << features.nbRoutesIn
-              << ", nbSB = " << std::setw(2) << features.nbSBEval
+              // << ", nbB = " << std::setw(2) << f.nbBranchingOn[row]
+              << ", nbRI = " << std::setw(2) << f.nbRoutesIn[row]
+              << ", nbSB = " << std::setw(2) << f.nbSBEval[row]
               << std::endl;
 }
 
-double cvrp_joao::BranchingFeatures::getSumDemandsNeighbors(int firstNode, int secondNode, const Data & data,
-                                                         const std::vector <std::vector<double>> & xSolution)
+// One pass over the positive edges of the solution
+void cvrp_joao::BranchingFeatures::updateNeighborsDemand(const Data & data, const SparseXSolution & xSolution)
 {
-    double sumDemandsNeighbors = data.customers[firstNode].demand + data.customers[secondNode].demand;
-    for (int i = 0; i < firstNode; i++)
+    lpNeighborsDemand.assign(xSolution.nbNodes(), 0.0);
+    lpDegree.assign(xSolution.nbNodes(), 0);
+    for (int e = 0; e < xSolution.nbEdges(); e++)
     {
-        if (xSolution[i][firstNode] > 0)
-            sumDemandsNeighbors += data.customers[i].demand + data.customers[firstNode].demand;
-
-        if (xSolution[i][secondNode] > 0)
-            sumDemandsNeighbors += data.customers[i].demand + data.customers[firstNode].demand;
-    }
-
-    for (int i = firstNode + 1; i < secondNode; i++)
-    {
-        if (xSolution[firstNode][i] > 0)
-            sumDemandsNeighbors += data.customers[i].demand + data.customers[firstNode].demand;
-
-        if (xSolution[i][secondNode] > 0)
-            sumDemandsNeighbors += data.customers[i].demand + data.customers[firstNode].demand;
+        int i = xSolution.edgeFirstNode(e), j = xSolution.edgeSecondNode(e);
+        lpNeighborsDemand[i] += data.customers[j].demand;
+        lpNeighborsDemand[j] += data.customers[i].demand;
+        lpDegree[i]++;
+        lpDegree[j]++;
     }
+}
 
-    for (int i = secondNode + 1; i <= data.nbCustomers; i++)
-    {
-        if (xSolution[firstNode][i] > 0)
-            sumDemandsNeighbors += data.customers[i].demand + data.customers[firstNode].demand;
-
-        if (xSolution[secondNode][i] > 0)
-            sumDemandsNeighbors += data.customers[i].demand + data.customers[firstNode].demand;
-    }
+// Demands of the endpoints plus, for each LP neighbor k of an endpoint (other than the other endpoint), the demand of
+// k and the demand of the first endpoint. Read from the sums of updateNeighborsDemand()
+double cvrp_joao::BranchingFeatures::getSumDemandsNeighbors(int firstNode, int secondNode, const Data & data,
+                                                         const SparseXSolution & xSolution) const
+{
+    double firstDemand = data.customers[firstNode].demand, secondDemand = data.customers[secondNode].demand;
+    bool adjacent = (xSolution.value(firstNode, secondNode) > 0);
+    double sumDemandsNeighbors = firstDemand + secondDemand;
+    sumDemandsNeighbors += lpNeighborsDemand[firstNode] - (adjacent ? secondDemand : 0.0)
+                           + firstDemand * (lpDegree[firstNode] - (adjacent ? 1 : 0));
+    sumDemandsNeighbors += lpNeighborsDemand[secondNode] - (adjacent ? firstDemand : 0.0)
+                           + firstDemand * (lpDegree[secondNode] - (adjacent ? 1 : 0));
 
     return sumDemandsNeighbors;
-}
\ No newline at end of file
+}
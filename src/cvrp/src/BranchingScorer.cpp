@@ -0,0 +1,163 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#include "BranchingScorer.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+const char * const cvrp_joao::BranchingScorer::featureNames[] = {"fracValue", "avgFracValue", "cost", "reducedCost",
+                                                                 "distDepot", "distConvexHull", "distNearestNeighbor",
+                                                                 "sumDemandsEndpoints", "sumDemandsNeighbors",
+                                                                 "nbBranchingOn", "nbRoutesIn", "nbSBEval"};
+
+int cvrp_joao::BranchingScorer::getFeature(const std::string & name)
+{
+    for (int k = 0; k < nbFeatures; k++)
+        if (name == featureNames[k])
+            return k;
+    return -1;
+}
+
+bool cvrp_joao::BranchingScorer::load(const std::string & fileName)
+{
+    std::ifstream ifs(fileName);
+    if (!ifs.is_open())
+    {
+        std::cerr << "Failed to open the branching scorer file " << fileName << std::endl;
+        return false;
+    }
+
+    modelType = ModelType::None;
+    bias = 0.0;
+    weights.assign(nbFeatures, 0.0);
+    treeRoots.clear();
+    nodeFeature.clear();
+    nodeThreshold.clear();
+    nodeLeft.clear();
+    nodeRight.clear();
+    nodeValue.clear();
+
+    auto fail = [&](int lineNumber, const std::string & message) {
+        std::cerr << "Branching scorer file " << fileName << ", line " << lineNumber << ": " << message << std::endl;
+        modelType = ModelType::None;
+        return false;
+    };
+
+    ModelType type = ModelType::None;
+    int treeEnd = 0; // position after the last node of the current tree
+    std::string line;
+    for (int lineNumber = 1; std::getline(ifs, line); lineNumber++)
+    {
+        std::istringstream iss(line);
+        std::string keyword;
+        if (!(iss >> keyword) || keyword[0] == '#')
+            continue;
+
+        if (type == ModelType::None)
+        {
+            if (keyword == "linear")
+                type = ModelType::Linear;
+            else if (keyword == "gbt")
+                type = ModelType::GradientBoostedTrees;
+            else
+                return fail(lineNumber, "unknown model type " + keyword);
+        }
+        else if (keyword == "bias")
+        {
+            if (!(iss >> bias))
+                return fail(lineNumber, "invalid bias");
+        }
+        else if (type == ModelType::Linear)
+        {
+            int k = getFeature(keyword);
+            if (k == -1 || !(iss >> weights[k]))
+                return fail(lineNumber, "invalid weight of " + keyword);
+        }
+        else if (keyword == "tree")
+        {
+            int nbNodes = 0;
+            if ((int) nodeFeature.size() != treeEnd)
+                return fail(lineNumber, "the previous tree is incomplete");
+            if (!(iss >> nbNodes) || nbNodes <= 0)
+                return fail(lineNumber, "invalid nb. of nodes");
+            treeRoots.push_back(treeEnd);
+            treeEnd += nbNodes;
+        }
+        else if (keyword == "split" || keyword == "leaf")
+        {
+            if (treeRoots.empty() || (int) nodeFeature.size() == treeEnd)
+                return fail(lineNumber, "node outside of a tree");
+            int root = treeRoots.back(), feature = -1, left = -1, right = -1;
+            double threshold = 0.0, value = 0.0;
+            if (keyword == "split")
+            {
+                std::string name;
+                if (!(iss >> name >> threshold >> left >> right) || (feature = getFeature(name)) == -1)
+                    return fail(lineNumber, "invalid split");
+                /// The children come after their parent, so every path ends at a leaf
+                int position = (int) nodeFeature.size() - root;
+                if (left <= position || right <= position || root + left >= treeEnd || root + right >= treeEnd)
+                    return fail(lineNumber, "invalid children");
+                left += root;
+                right += root;
+            }
+            else if (!(iss >> value))
+                return fail(lineNumber, "invalid leaf");
+            nodeFeature.push_back(feature);
+            nodeThreshold.push_back(threshold);
+            nodeLeft.push_back(left);
+            nodeRight.push_back(right);
+            nodeValue.push_back(value);
+        }
+        else
+            return fail(lineNumber, "unknown keyword " + keyword);
+    }
+    if (type == ModelType::None)
+        return fail(0, "empty model");
+    if ((int) nodeFeature.size() != treeEnd)
+        return fail(0, "the last tree is incomplete");
+
+    modelType = type;
+    std::cout << "Branching scorer loaded from " << fileName << ": "
+              << ((modelType == ModelType::Linear) ? "linear model" : std::to_string(treeRoots.size()) + " tree(s)")
+              << std::endl;
+    return true;
+}
+
+void cvrp_joao::BranchingScorer::predict(const double * features, int nbRows, double * scores) const
+{
+    for (int r = 0; r < nbRows; r++)
+        scores[r] = bias;
+
+    if (modelType == ModelType::Linear)
+    {
+        /// One pass per feature over contiguous columns, which the compiler vectorizes
+        for (int k = 0; k < nbFeatures; k++)
+        {
+            double weight = weights[k];
+            if (weight == 0.0)
+                continue;
+            const double * column = features + (size_t) k * nbRows;
+            for (int r = 0; r < nbRows; r++)
+                scores[r] += weight * column[r];
+        }
+    }
+    else if (modelType == ModelType::GradientBoostedTrees)
+    {
+        /// Tree by tree, so the nodes of a tree stay in cache while all rows go through it
+        for (const auto & root : treeRoots)
+            for (int r = 0; r < nbRows; r++)
+            {
+                int node = root;
+                while (nodeFeature[node] != -1)
+                    node = (features[(size_t) nodeFeature[node] * nbRows + r] < nodeThreshold[node]) ? nodeLeft[node]
+                                                                                                    : nodeRight[node];
+                scores[r] += nodeValue[node];
+            }
+    }
+}
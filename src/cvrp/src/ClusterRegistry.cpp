@@ -0,0 +1,85 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#include "ClusterRegistry.h"
+
+#include <algorithm>
+
+std::pair<int, bool> ds::ClusterRegistry::insert(const std::vector<int> & cluster)
+{
+    auto sortedCluster = canonical(cluster);
+    auto key = hash(sortedCluster);
+    auto id = find(sortedCluster, key);
+    if (id != -1)
+        return std::make_pair(id, false);
+
+    id = firstId + (int) clusters.size();
+    clusters.push_back(std::move(sortedCluster));
+    index.emplace(key, id);
+    return std::make_pair(id, true);
+}
+
+int ds::ClusterRegistry::find(const std::vector<int> & cluster) const
+{
+    if (std::is_sorted(cluster.begin(), cluster.end()))
+        return find(cluster, hash(cluster));
+
+    auto sortedCluster = canonical(cluster);
+    return find(sortedCluster, hash(sortedCluster));
+}
+
+int ds::ClusterRegistry::find(const std::vector<int> & sortedCluster, uint64_t key) const
+{
+    // Different clusters may share the same hash, so the canonical forms are compared
+    auto range = index.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+        if (clusters[it->second - firstId] == sortedCluster)
+            return it->second;
+    return -1;
+}
+
+void ds::ClusterRegistry::erase(int id)
+{
+    auto & sortedCluster = clusters[id - firstId];
+    auto range = index.equal_range(hash(sortedCluster));
+    for (auto it = range.first; it != range.second; ++it)
+        if (it->second == id)
+        {
+            index.erase(it);
+            break;
+        }
+    std::vector<int>().swap(sortedCluster);
+}
+
+uint64_t ds::ClusterRegistry::hash(const std::vector<int> & sortedCluster)
+{
+    return hash(sortedCluster.data(), sortedCluster.data() + sortedCluster.size());
+}
+
+uint64_t ds::ClusterRegistry::hash(const int * first, const int * last)
+{
+    // FNV-1a over the elements, followed by a splitmix64 finalizer
+    uint64_t h = 14695981039346656037ULL;
+    for (auto it = first; it != last; ++it)
+    {
+        h ^= (uint64_t) (uint32_t) *it;
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+std::vector<int> ds::ClusterRegistry::canonical(const std::vector<int> & cluster)
+{
+    std::vector<int> sortedCluster(cluster);
+    if (!std::is_sorted(sortedCluster.begin(), sortedCluster.end()))
+        std::sort(sortedCluster.begin(), sortedCluster.end());
+    return sortedCluster;
+}
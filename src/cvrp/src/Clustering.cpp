@@ -12,10 +12,9 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
-#include <map>
 
 cluster::MSTClustering::MSTClustering(const cvrp_joao::Data *data, const ClusteringParams & clusteringParams, bool verbose) :
-        clusters(), graph(data), mstTree(), vertexDegree(), mstWeight(0), avgMSTWeight(0), stDevMSTWeight(0)
+        clusters(), graph(data, clusteringParams.enableSparseMST()), mstTree(), vertexDegree(), mstWeight(0), avgMSTWeight(0), stDevMSTWeight(0)
 {
     // MST clustering
     kruskalMST(verbose);
@@ -90,59 +89,44 @@ void cluster::MSTClustering::splitMST(const ClusteringParams & clusteringParams)
     std::cout << "Clustering algorithm parametrization: stDevMult("  << stDevMultiplierAux
               << "), ClusterSizeThreshold(" << clusteringParams.bigClustersSizeThreshold() << ") " << std::endl;
 
-    ds::DisjointSets dsSets(graph.n);
-    std::map<std::pair<int, int>, bool> edgesHasParent;
+    // The components of the MST edges lighter than the cutoff are nodes of the single-linkage dendrogram
+    ds::Dendrogram dendrogram(graph.n, mstTree);
+    std::vector<bool> edgesHasParent(mstTree.size(), false);
 
     // Splitting by cutoff
-    for (const auto & edge: mstTree)
+    for (int k = 0; k < mstTree.size(); k++)
     {
-        int firstVertex = edge.first.first;
-        int secondVertex = edge.first.second;
-        if (edge.second < edgeCutOff)
+        if (mstTree[k].second < edgeCutOff)
         {
-            dsSets.unionRank(firstVertex, secondVertex);
-            edgesHasParent[std::make_pair(firstVertex, secondVertex)] = true;
+            edgesHasParent[k] = true;
         }
         else
         {
-            edgesHasParent[std::make_pair(firstVertex, secondVertex)] = false;
-            vertexDegree[firstVertex] -= 1;
-            vertexDegree[secondVertex] -= 1;
-        }
-    }
-    // Identifying dsSets
-    std::vector<std::vector<Edge>> parentsTree(graph.n + 1);
-    for (const auto & edge: mstTree)
-    {
-        int firstVertex = edge.first.first;
-        int secondVertex = edge.first.second;
-        if (edgesHasParent[std::make_pair(firstVertex, secondVertex)])
-        {
-            parentsTree[dsSets.findParent(firstVertex)].push_back(edge);
+            vertexDegree[mstTree[k].first.first] -= 1;
+            vertexDegree[mstTree[k].first.second] -= 1;
         }
     }
-    // dsSets.getDisjointSets(n, true, 2);
 
     // Splitting cluster by maximum size
     if (!clusteringParams.enableBigClusters()) {
         std::cout << "Splits by cluster size... " << std::endl;
-        for (const auto &tree: parentsTree) {
-            double sz = (int) tree.size() > 0 ? (int) tree.size() + 1 : 0;
+        for (const auto & node: dendrogram.cut(edgeCutOff)) {
+            double sz = dendrogram.isLeaf(node) ? 0 : dendrogram.size(node);
             if (sz > maxClusterSize) {
                 int nbSplit = std::ceil(sz / maxClusterSize);
                 std::cout << "|--> Size: " << sz << ", nbSplits: " << nbSplit << std::endl;
-                auto it = tree.rbegin();
-                while (nbSplit > 0) {
-                    int firstVertex = (it)->first.first;
-                    int secondVertex = (it)->first.second;
+                // Removing the most costly edges of the cluster first
+                auto tree = dendrogram.subtreeEdges(node);
+                for (auto it = tree.rbegin(); nbSplit > 0 && it != tree.rend(); it++) {
+                    int firstVertex = mstTree[*it].first.first;
+                    int secondVertex = mstTree[*it].first.second;
                     if (vertexDegree[firstVertex] > 1 // To avoid singleton clusters
                         && vertexDegree[secondVertex] > 1) {
-                        edgesHasParent[std::make_pair(firstVertex, secondVertex)] = false;
+                        edgesHasParent[*it] = false;
                         vertexDegree[firstVertex] -= 1;
                         vertexDegree[secondVertex] -= 1;
                         nbSplit--;
                     }
-                    it++;
                 }
             }
         }
@@ -152,14 +136,13 @@ void cluster::MSTClustering::splitMST(const ClusteringParams & clusteringParams)
     if (!clusteringParams.enableSingletons())
     {
         std::cout << "Connecting singletons... ";
-        // for (auto edge = mstTree.rbegin(); edge != mstTree.rend(); edge++)
-        for (const auto &edge: mstTree) {
-            if (edge.second < edgeCutOff) continue;
+        for (int k = 0; k < mstTree.size(); k++) {
+            if (mstTree[k].second < edgeCutOff) continue;
 
-            int firstVertex = edge.first.first;
-            int secondVertex = edge.first.second;
+            int firstVertex = mstTree[k].first.first;
+            int secondVertex = mstTree[k].first.second;
             if (vertexDegree[firstVertex] == 0 || vertexDegree[secondVertex] == 0) {
-                edgesHasParent[std::make_pair(firstVertex, secondVertex)] = true;
+                edgesHasParent[k] = true;
                 vertexDegree[firstVertex] += 1;
                 vertexDegree[secondVertex] += 1;
 
@@ -174,9 +157,9 @@ void cluster::MSTClustering::splitMST(const ClusteringParams & clusteringParams)
 
     // Identifying clusters
     ds::DisjointSets dsSetsAux(graph.n);
-    for (const auto & edge: edgesHasParent)
-        if (edge.second)
-            dsSetsAux.unionRank(edge.first.first, edge.first.second);
+    for (int k = 0; k < mstTree.size(); k++)
+        if (edgesHasParent[k])
+            dsSetsAux.unionRank(mstTree[k].first.first, mstTree[k].first.second);
     clusters = dsSetsAux.getDisjointSets(graph.n);
 }
 
@@ -199,32 +182,35 @@ void cluster::MSTClustering::multiSplitMST(const ClusteringParams & clusteringPa
     std::cout << "Clustering algorithm parametrization: stDevMult("  << stDevMultiplierAux
               << "), ClusterSizeThreshold(" << clusteringParams.bigClustersSizeThreshold() << ") " << std::endl;
 
-    // Splitting by cutoff
+    // Splitting by cutoff: removing the MST edges from the most costly one. Removing the edge 'pos' splits its
+    // dendrogram node in its two children, so only those can be new clusters (all the components at the first step)
+    ds::Dendrogram dendrogram(graph.n, mstTree);
+    ds::ClusterRegistry registry;
+    for (const auto & clu : clusters)
+        registry.insert(clu);
     int pos = mstTree.size() - 1;
+    bool firstStep = true;
     while (true) // Clustering for each edge removed
     {
-        ds::DisjointSets dsSets(graph.n);
-        for (int i = 0; i < pos; i++)
+        std::vector<int> nodes;
+        if (firstStep)
+        {
+            nodes = dendrogram.components(pos);
+            firstStep = false;
+        }
+        else
         {
-            int firstVertex = mstTree[i].first.first;
-            int secondVertex = mstTree[i].first.second;
-            dsSets.unionRank(firstVertex, secondVertex);
+            auto node = dendrogram.edgeNode(pos);
+            nodes = {dendrogram.leftChild(node), dendrogram.rightChild(node)};
+            if (dendrogram.minVertex(nodes[1]) < dendrogram.minVertex(nodes[0]))
+                std::swap(nodes[0], nodes[1]);
         }
 
-        auto clustersAux = dsSets.getDisjointSets(graph.n);
-        for (auto & clu1: clustersAux)
+        for (const auto & node: nodes)
         {
-            bool exists = false;
-            for (auto & clu2: clusters)
-            {
-                if (ds::Utils::compare(clu1, clu2))
-                {
-                    exists = true;
-                    break;
-                }
-            }
-            if (!exists)
-                clusters.push_back(clu1);
+            auto clu = dendrogram.members(node);
+            if (registry.insert(clu).second)
+                clusters.push_back(clu);
         }
 
         pos--;
@@ -366,7 +352,7 @@ void cluster::TSPClustering::splitTSP(const ClusteringParams & clusteringParams)
 }
 
 cluster::Clustering::Clustering() :
-        clusters(), clustersAtRoot(), routeClusters(), vertexCluster(), vertexRouteCluster(), clusterCustomers(), disjoint(),
+        clusters(), clustersAtRoot(), routeClusters(), vertexCluster(), vertexRouteCluster(), vertexClusters(), clusterCustomers(), intersecting(),
         data(nullptr), clusteringParams(nullptr), nbMSTclusters(0), nbTSPclusters(0)
 {}
 
@@ -401,26 +387,13 @@ void cluster::Clustering::loadClusters()
 
             clustersAux = MSTclusters.clusters;
             // clustersAux.insert(clustersAux.end(), TSPclusters.clusters.begin(), TSPclusters.clusters.end());
+            ds::ClusterRegistry registry;
+            for (const auto & clu : clustersAux)
+                registry.insert(clu);
             auto nbEqClusters = 0;
-            for (const auto clu1 : TSPclusters.clusters) {
-                bool exist = false;
-                for (const auto clu2 : clustersAux) {
-                    if (clu1.size() != clu2.size())
-                        continue;
-                    bool equals = true;
-                    for (int i = 0; i < clu1.size(); ++i) {
-                        if (clu1[i] != clu2[i]) {
-                            equals = false;
-                            break;
-                        }
-                    }
-                    if (equals) {
-                        exist = true;
-                        break;
-                    }
-                }
-                if (!exist)
-                    clustersAux.push_back(clu1);
+            for (const auto & clu : TSPclusters.clusters) {
+                if (registry.insert(clu).second)
+                    clustersAux.push_back(clu);
                 else
                     nbEqClusters++;
             }
@@ -459,17 +432,25 @@ void cluster::Clustering::loadClusters()
         exit(1);
     }
 
-    // Checking for intersected clusters and identifying customer clusters
-    disjoint = std::vector<std::vector<bool>>(nbClusters() + 1, std::vector<bool> (nbClusters() + 1, true));
-    clusterCustomers = std::vector<std::vector<bool>> (nbClusters() + 1, std::vector<bool> (data->nbCustomers + 1, false));
+    // Identifying customer clusters and checking for intersected clusters (word-wise AND of the membership bitsets)
+    intersecting = std::vector<ds::Bitset>(nbClusters() + 1, ds::Bitset(nbClusters() + 1));
+    clusterCustomers = std::vector<ds::Bitset> (nbClusters() + 1, ds::Bitset(data->nbCustomers + 1));
+    for (auto & cluster : clusters)
+        for (auto & cust : cluster.second)
+            clusterCustomers[cluster.first].set(cust);
+
     for (int i = 0; i < clusters.size(); i++)
     {
+        auto firstClusterId = clusters[i].first;
         for (int j = i + 1; j < clusters.size(); j++)
-            if (ds::Utils::intersection(clusters[i].second, clusters[j].second))
-                disjoint[clusters[i].first][clusters[j].first] = disjoint[clusters[j].first][clusters[i].first] = false;
-
-        for (auto & cust : clusters[i].second)
-            clusterCustomers[clusters[i].first][cust] = true;
+        {
+            auto secondClusterId = clusters[j].first;
+            if (clusterCustomers[firstClusterId].intersects(clusterCustomers[secondClusterId]))
+            {
+                intersecting[firstClusterId].set(secondClusterId);
+                intersecting[secondClusterId].set(firstClusterId);
+            }
+        }
     }
     // Showing results
     printClusters(clusters);
@@ -514,10 +495,12 @@ void cluster::Clustering::getVerticesClusterId(int n, bool fromRouteCluster) {
         }
 
         vertexCluster = std::vector<int> (n+1, -1);
+        vertexClusters = std::vector<std::vector<int>> (n+1);
         for (int clusterIdx = 1; clusterIdx <= nbClusters(); ++clusterIdx)
         {
             for (const auto vertexId : clusters[clusterIdx - 1].second) {
                 vertexCluster[vertexId] = clusterIdx;
+                vertexClusters[vertexId].push_back(clusterIdx - 1);
             }
         }
     }
@@ -7,37 +7,28 @@
 #include "Cutsets.h"
 #include "cnstrmgr.h"
 
-#include <string>
-#include <sstream>
 #include <algorithm>
 
-cvrp_joao::Cutsets::Cutsets(int nbCustomers_, int vehCapacity, std::vector<int> demands,
-                            int nbEdges, std::vector<int> edgeTail,
-                            std::vector<int> edgeHead, std::vector<double> edgeLPValue,
-                            double target_, int nbSets_, bool verbose_)
-                            : setsCMP(), nbCustomers(nbCustomers_), boundaryTarget(setTarget(target_)), nbSets(setNbOfSets(nbSets_)), verbose(verbose_)
+cvrp_joao::Cutsets::Cutsets(const Data & data, double target_, int nbSets_, int maxOldSets_, bool verbose_)
+                            : nbCustomers(data.nbCustomers), vehCapacity(data.veh_capacity),
+                              demands(data.nbCustomers + 1, 0), setsCMP(nullptr), oldSetsCMP(nullptr), verbose(verbose_),
+                              boundaryTarget(setTarget(target_)), nbSets(setNbOfSets(nbSets_)),
+                              maxOldSets(maxOldSets_ > 0 ? maxOldSets_ : 10 * nbSets), registry(),
+                              cutsets(), lastSeparation(), nbSeparations(0)
 {
+    for (int custId = 1; custId <= nbCustomers; ++custId)
+        demands[custId] = data.customers[custId].demand;
+
     /// Initializing the cutsets data structure
-    CMGR_FreeMemCMgr(&setsCMP);
-    CMGR_CreateCMgr(&setsCMP,nbSets);
+    CMGR_CreateCMgr(&setsCMP, nbSets);
     /// Required to store previously separated cutssets
-    CnstrMgrPointer MyOldCutsCMP; /// Not used in practice here
-    CMGR_CreateCMgr(&MyOldCutsCMP,0);
-    /// Generating candidates list (stored in setsCMP) - Function from CVRPSEP lib
-    /// the CVRPSEP default assume that the depot is numbered nbCustomers + 1
-    /// Only information on those edges e with LP value x_e > 0 should be passed
-    std::cout << "Searching for cutsets" << std::endl;
-    BRNCHING_GetCandidateSets(nbCustomers,
-                              demands.data(),
-                              vehCapacity,
-                              nbEdges,
-                              edgeTail.data(),
-                              edgeHead.data(),
-                              edgeLPValue.data(),
-                              MyOldCutsCMP,
-                              boundaryTarget,
-                              nbSets,
-                              setsCMP);
+    CMGR_CreateCMgr(&oldSetsCMP, maxOldSets);
+}
+
+cvrp_joao::Cutsets::~Cutsets()
+{
+    CMGR_FreeMemCMgr(&setsCMP);
+    CMGR_FreeMemCMgr(&oldSetsCMP);
 }
 
 double cvrp_joao::Cutsets::setTarget(double target_) const {
@@ -61,47 +52,70 @@ int cvrp_joao::Cutsets::setNbOfSets(int nbSets_) const {
     return nb;
 }
 
-cvrp_joao::cutsetsMap cvrp_joao::Cutsets::getCutsets() {
-    /// The same as setCMP but using unordered_map datastructures
-    /// The string is hash name and the pair.fist = cutset, pair.second = cutset rhs
-    cutsetsMap sets;
+const std::vector<cvrp_joao::Cutset> & cvrp_joao::Cutsets::separate(int nbEdges, const int * edgeTail,
+                                                                    const int * edgeHead, const double * edgeLPValue)
+{
+    /// Generating candidates list (stored in setsCMP) - Function from CVRPSEP lib
+    /// CVRPSEP does not modify the edges arrays, but its interface is not const
+    std::cout << "Searching for cutsets" << std::endl;
+    BRNCHING_GetCandidateSets(nbCustomers,
+                              demands.data(),
+                              vehCapacity,
+                              nbEdges,
+                              const_cast<int *>(edgeTail),
+                              const_cast<int *>(edgeHead),
+                              const_cast<double *>(edgeLPValue),
+                              oldSetsCMP,
+                              boundaryTarget,
+                              nbSets,
+                              setsCMP);
+
+    nbSeparations++;
+    cutsets.clear();
     for (int i = 0; i < setsCMP->Size; i++) {
-        std::vector<int> list;
+        Cutset cutset;
         for (int j = 1; j <= setsCMP->CPL[i]->IntListSize; j++)
-            list.push_back(setsCMP->CPL[i]->IntList[j]);
+            cutset.customers.push_back(setsCMP->CPL[i]->IntList[j]);
         /// Now list contains the numbers of the customers in S
         /// The boundary x^*(\delta(S)) of this S is RHS
-        auto rhs = setsCMP->CPL[i]->RHS;
-        std::sort(list.begin(), list.end());
-        auto name = generateUniqueName(list);
-        sets[name] = std::make_pair(list, rhs);
+        std::sort(cutset.customers.begin(), cutset.customers.end());
+        cutset.rhs = setsCMP->CPL[i]->RHS;
+        cutset.id = registry.insert(cutset.customers).first;
+
+        if (cutset.id >= (int) lastSeparation.size())
+            lastSeparation.resize(cutset.id + 1, 0);
+        if (lastSeparation[cutset.id] == nbSeparations)
+            continue;
+        lastSeparation[cutset.id] = nbSeparations;
+        cutsets.push_back(std::move(cutset));
     }
-    /// CMGR_FreeMemCMgr(&setsCMP); /// Deallocate the memory
+    moveSetsToPool();
 
-    std::cout << "Number of generated cutsets: " << sets.size() << std::endl;
+    std::cout << "Number of generated cutsets: " << cutsets.size() << std::endl;
 
-    return sets;
+    return cutsets;
 }
 
-/// Function to generate a unique name for the vector based on its elements
-std::string cvrp_joao::Cutsets::generateUniqueName(const std::vector<int> & vec) {
-    /// Use a hash function to generate a unique identifier based on the elements of the vector
-    std::hash<std::string> hasher;
-    std::stringstream ss;
-    for (int elem : vec) {
-        ss << elem << ",";
+void cvrp_joao::Cutsets::moveSetsToPool()
+{
+    /// The pool is bounded: once full, it restarts with the sets of the last call
+    if (oldSetsCMP->Size + setsCMP->Size > maxOldSets)
+    {
+        CMGR_FreeMemCMgr(&oldSetsCMP);
+        CMGR_CreateCMgr(&oldSetsCMP, maxOldSets);
     }
-    std::string identifier = ss.str();
-    return "cutset_" + std::to_string(hasher(identifier));
+
+    /// Moving the constraint records keeps setsCMP empty (and its memory reused) for the next call
+    for (int i = 0; i < setsCMP->Size; i++)
+        CMGR_MoveCnstr(setsCMP, oldSetsCMP, i, 0);
+    setsCMP->Size = 0;
 }
 
-void cvrp_joao::Cutsets::printCutsets(const cutsetsMap & myMap) {
-    for (const auto & pair : myMap) {
-        std::cout << "Cutset[" << pair.first << "] ";
-        for (const auto & i : pair.second.first)
+void cvrp_joao::Cutsets::printCutsets(const std::vector<const Cutset *> & sets) {
+    for (const auto & cutset : sets) {
+        std::cout << "Cutset[" << cutset->id << "] ";
+        for (const auto & i : cutset->customers)
             std::cout << i << " ";
         std::cout << std::endl;
     }
 }
-
-
@@ -55,21 +55,24 @@ bool ds::Utils::intersection(std::vector<int> & vec1, std::vector<int> & vec2)
 }
 
 
-ds::DisjointSets::DisjointSets(int n) : parent(new int[n+1]), rank(new int[n+1]), sets()
+ds::DisjointSets::DisjointSets(int n) : parent(), rank(), setIndex(), setStart(), setElements(), nbGroupedSets(0)
 {
-    for (int i = 1; i < n + 1; i++)
-    {
-        parent[i] = -1;
-        rank[i] = 1;
-    }
+    reset(n);
 }
 
-int ds::DisjointSets::findParent(int i)
+void ds::DisjointSets::reset(int n)
 {
-    if (parent[i] == -1)
-        return i;
+    parent.resize(n + 1);
+    rank.assign(n + 1, 1);
+    for (int i = 0; i <= n; i++)
+        parent[i] = i;
+}
 
-    return parent[i] = findParent(parent[i]);
+int ds::DisjointSets::findParent(int i)
+{
+    while (parent[i] != i)
+        i = parent[i] = parent[parent[i]];
+    return i;
 }
 
 void ds::DisjointSets::unionRank(int x, int y)
@@ -97,34 +100,51 @@ void ds::DisjointSets::unionRank(int x, int y)
 
 void ds::DisjointSets::printDisjointSets(int firstSetId) {
 
-    if (sets.empty())
-        std::cerr << "The sets are not defined yet! Please use getDisjointSets() first!" << std::endl;
+    if (nbGroupedSets == 0)
+        std::cerr << "The sets are not defined yet! Please use groupSets() first!" << std::endl;
 
     std::cout << "+------ Printing disjoint sets ------+" << std::endl;
-    printSets(sets, firstSetId);
+    for (int k = 0; k < nbGroupedSets; k++)
+    {
+        std::cout << "C" << firstSetId + k;
+        for (auto it = setBegin(k); it != setEnd(k); ++it)
+            std::cout << " " << *it;
+        std::cout << std::endl;
+    }
     std::cout << "+----------- End of print -----------+" << std::endl;
 }
 
-std::vector<std::vector<int>> ds::DisjointSets::getDisjointSets(int n, bool verbose, int firstSetId)
+int ds::DisjointSets::groupSets(int n)
 {
-    sets.clear();
-    std::vector<bool> inSet(n+1, false);
-    for (int firstVertex = 1; firstVertex <= n; firstVertex++) {
-        if (inSet[firstVertex]) continue;
-        std::vector<int> setAux;
-        setAux.push_back(firstVertex);
-        inSet[firstVertex] = true;
-
-        for (int secondVertex = firstVertex + 1; secondVertex <= n ; secondVertex++)
-        {
-            if (findParent(firstVertex) == findParent(secondVertex))
-            {
-                setAux.push_back(secondVertex);
-                inSet[secondVertex] = true;
-            }
-        }
-        sets.push_back(setAux);
+    // Counting pass: the sets are numbered in the order of their smallest element, and the size of set k is counted
+    // in setStart[k + 2], so that after the prefix sums setStart[k + 1] is the start of set k. Filling the sets in
+    // increasing order then moves setStart[k + 1] to the end of set k, which is the start of set k + 1
+    setIndex.assign(n + 1, -1);
+    setStart.assign(n + 3, 0);
+    nbGroupedSets = 0;
+    for (int vertex = 1; vertex <= n; vertex++)
+    {
+        int root = findParent(vertex);
+        if (setIndex[root] == -1)
+            setIndex[root] = nbGroupedSets++;
+        setStart[setIndex[root] + 2]++;
     }
+    for (int k = 2; k <= nbGroupedSets + 1; k++)
+        setStart[k] += setStart[k - 1];
+
+    setElements.resize(n);
+    for (int vertex = 1; vertex <= n; vertex++)
+        setElements[setStart[setIndex[findParent(vertex)] + 1]++] = vertex;
+    return nbGroupedSets;
+}
+
+std::vector<std::vector<int>> ds::DisjointSets::getDisjointSets(int n, bool verbose, int firstSetId)
+{
+    groupSets(n);
+    std::vector<std::vector<int>> sets;
+    sets.reserve(nbGroupedSets);
+    for (int k = 0; k < nbGroupedSets; k++)
+        sets.emplace_back(setBegin(k), setEnd(k));
 
     if (verbose)
         printDisjointSets(firstSetId);
@@ -134,7 +154,13 @@ std::vector<std::vector<int>> ds::DisjointSets::getDisjointSets(int n, bool verb
 
 
 //ds::Graph::Graph(double (cvrp_joao::Data::*costFunction)(int, int), cvrp_joao::Data &obj, int n_)
-ds::Graph::Graph(const cvrp_joao::Data *data) : n(data->nbCustomers), edges() {
+ds::Graph::Graph(const cvrp_joao::Data *data, bool sparse) : n(data->nbCustomers), edges() {
+    if (sparse)
+    {
+        boruvkaEMST(data);
+        return;
+    }
+
     for (int firstNodeId = 1; firstNodeId < n; ++firstNodeId)
         for (int secondNodeId = firstNodeId + 1; secondNodeId <= n; ++secondNodeId)
         {
@@ -148,49 +174,338 @@ void ds::Graph::addEdge(int x, int y, double weight)
     edges.push_back({{x, y}, weight});
 }
 
+// Boruvka algorithm over the 2-d tree: at each round every component is linked to its nearest foreign vertex.
+// Ties are broken by (squared distance, smallest id, largest id), so the result is an Euclidean MST of the
+// complete graph. As rounding the distances is monotone, it is also a MST for the rounded weights,
+// and kruskalMST gives the same weights (and hence the same clusters by cutoff) as with the complete graph.
+void ds::Graph::boruvkaEMST(const cvrp_joao::Data *data)
+{
+    if (n < 2)
+        return;
+
+    KdTree tree(data);
+    DisjointSets sets(n);
+    std::vector<int> component(n + 1, -1);
+    // Per component: pair <first vertex, second vertex>, squared distance
+    std::vector<std::pair<std::pair<int, int>, double>> nearest(n + 1);
+    auto nbComponents = n;
+
+    while (nbComponents > 1)
+    {
+        for (int i = 1; i <= n; i++)
+        {
+            component[i] = sets.findParent(i);
+            nearest[i] = {{-1, -1}, DBL_MAX};
+        }
+        tree.updateComponents(component);
+
+        for (int i = 1; i <= n; i++)
+        {
+            auto candidate = tree.nearestForeign(i);
+            int firstVertex = std::min(i, candidate.first), secondVertex = std::max(i, candidate.first);
+            auto & best = nearest[component[i]];
+            if ((candidate.second < best.second)
+                || (candidate.second == best.second && std::make_pair(firstVertex, secondVertex) < best.first))
+                best = {{firstVertex, secondVertex}, candidate.second};
+        }
+
+        for (int i = 1; i <= n; i++)
+        {
+            if (component[i] != i)
+                continue;
+
+            int firstVertex = nearest[i].first.first, secondVertex = nearest[i].first.second;
+            if (sets.findParent(firstVertex) != sets.findParent(secondVertex))
+            {
+                sets.unionRank(firstVertex, secondVertex);
+                addEdge(firstVertex, secondVertex, data->getCustToCustDistance(firstVertex, secondVertex));
+                nbComponents--;
+            }
+        }
+    }
+}
+
+
+ds::KdTree::KdTree(const cvrp_joao::Data *data) : x(data->nbCustomers + 1), y(data->nbCustomers + 1),
+                                                  ids(), vertexComponent(data->nbCustomers + 1, -1), nodes()
+{
+    for (int i = 1; i <= data->nbCustomers; i++)
+    {
+        x[i] = data->customers[i].x;
+        y[i] = data->customers[i].y;
+        ids.push_back(i);
+    }
+    if (!ids.empty())
+        build(0, (int) ids.size());
+}
+
+int ds::KdTree::build(int begin, int end)
+{
+    const int leafSize = 8;
+    int nodeId = (int) nodes.size();
+    nodes.push_back({begin, end, -1, -1, -1, DBL_MAX, -DBL_MAX, DBL_MAX, -DBL_MAX});
+    for (int k = begin; k < end; k++)
+    {
+        auto & node = nodes[nodeId];
+        node.minX = std::min(node.minX, x[ids[k]]);
+        node.maxX = std::max(node.maxX, x[ids[k]]);
+        node.minY = std::min(node.minY, y[ids[k]]);
+        node.maxY = std::max(node.maxY, y[ids[k]]);
+    }
+
+    if (end - begin > leafSize)
+    {
+        // Split by the median of the coordinate of largest spread
+        bool byX = (nodes[nodeId].maxX - nodes[nodeId].minX) >= (nodes[nodeId].maxY - nodes[nodeId].minY);
+        int middle = begin + (end - begin) / 2;
+        std::nth_element(ids.begin() + begin, ids.begin() + middle, ids.begin() + end,
+                         [this, byX](int a, int b) { return byX ? x[a] < x[b] : y[a] < y[b]; });
+        int left = build(begin, middle);
+        int right = build(middle, end);
+        nodes[nodeId].left = left;
+        nodes[nodeId].right = right;
+    }
+
+    return nodeId;
+}
+
+void ds::KdTree::updateComponents(const std::vector<int> & component)
+{
+    vertexComponent = component;
+    if (!nodes.empty())
+        updateComponent(0);
+}
+
+int ds::KdTree::updateComponent(int nodeId)
+{
+    auto & node = nodes[nodeId];
+    int comp;
+    if (node.left == -1)
+    {
+        comp = vertexComponent[ids[node.begin]];
+        for (int k = node.begin + 1; k < node.end; k++)
+            if (vertexComponent[ids[k]] != comp)
+            {
+                comp = -1;
+                break;
+            }
+    }
+    else
+    {
+        int leftComp = updateComponent(node.left);
+        int rightComp = updateComponent(node.right);
+        comp = (leftComp == rightComp) ? leftComp : -1;
+    }
+    nodes[nodeId].component = comp;
+    return comp;
+}
+
+std::pair<int, double> ds::KdTree::nearestForeign(int i) const
+{
+    int best = -1;
+    double bestSqDist = DBL_MAX;
+    if (!nodes.empty())
+        search(0, i, best, bestSqDist);
+    return std::make_pair(best, bestSqDist);
+}
+
+void ds::KdTree::search(int nodeId, int i, int & best, double & bestSqDist) const
+{
+    const auto & node = nodes[nodeId];
+    if (node.component != -1 && node.component == vertexComponent[i])
+        return;
+
+    double dx = std::max({0.0, node.minX - x[i], x[i] - node.maxX});
+    double dy = std::max({0.0, node.minY - y[i], y[i] - node.maxY});
+    // Equal distances are still explored to break ties by the smallest id
+    if (dx * dx + dy * dy > bestSqDist)
+        return;
+
+    if (node.left == -1)
+    {
+        for (int k = node.begin; k < node.end; k++)
+        {
+            int j = ids[k];
+            if (vertexComponent[j] == vertexComponent[i])
+                continue;
+
+            double sqDist = (x[j] - x[i]) * (x[j] - x[i]) + (y[j] - y[i]) * (y[j] - y[i]);
+            if (sqDist < bestSqDist || (sqDist == bestSqDist && j < best))
+            {
+                best = j;
+                bestSqDist = sqDist;
+            }
+        }
+        return;
+    }
+
+    // Visiting first the child closest to the vertex
+    const auto & left = nodes[node.left];
+    bool leftFirst = (left.minX <= x[i] && x[i] <= left.maxX && left.minY <= y[i] && y[i] <= left.maxY);
+    search(leftFirst ? node.left : node.right, i, best, bestSqDist);
+    search(leftFirst ? node.right : node.left, i, best, bestSqDist);
+}
+
+
+ds::Dendrogram::Dendrogram(int n_, const std::vector<Edge> & mstEdges) : n(n_), left(), right(), parent(), nodeSize(),
+                                                                          nodeMinVertex(), leafBegin(), nodeHeight(),
+                                                                          leafOrder(), roots()
+{
+    auto nbNodes = n + 1 + (int) mstEdges.size();
+    left.assign(nbNodes, -1);
+    right.assign(nbNodes, -1);
+    parent.assign(nbNodes, -1);
+    nodeSize.assign(nbNodes, 1);
+    nodeHeight.assign(nbNodes, 0.0);
+    nodeMinVertex.resize(nbNodes);
+    for (int i = 0; i <= n; i++)
+        nodeMinVertex[i] = i;
+
+    // Replaying Kruskal: 'top' is the current dendrogram node of each union-find root
+    std::vector<int> setParent(n + 1), top(n + 1);
+    for (int i = 1; i <= n; i++)
+        setParent[i] = top[i] = i;
+    auto findSet = [&setParent](int i) {
+        while (setParent[i] != i)
+            i = setParent[i] = setParent[setParent[i]];
+        return i;
+    };
+    for (int k = 0; k < (int) mstEdges.size(); k++)
+    {
+        int firstSet = findSet(mstEdges[k].first.first), secondSet = findSet(mstEdges[k].first.second);
+        int node = edgeNode(k);
+        left[node] = top[firstSet];
+        right[node] = top[secondSet];
+        parent[left[node]] = parent[right[node]] = node;
+        nodeSize[node] = nodeSize[left[node]] + nodeSize[right[node]];
+        nodeMinVertex[node] = std::min(nodeMinVertex[left[node]], nodeMinVertex[right[node]]);
+        nodeHeight[node] = mstEdges[k].second;
+        setParent[secondSet] = firstSet;
+        top[firstSet] = node;
+    }
+
+    // DFS numbering of the leaves
+    for (int node = 1; node < nbNodes; node++)
+        if (parent[node] == -1)
+            roots.push_back(node);
+    leafBegin.assign(nbNodes, 0);
+    std::vector<int> stack(roots.rbegin(), roots.rend());
+    while (!stack.empty())
+    {
+        int node = stack.back();
+        stack.pop_back();
+        leafBegin[node] = (int) leafOrder.size();
+        if (isLeaf(node))
+        {
+            leafOrder.push_back(node);
+            continue;
+        }
+        stack.push_back(right[node]);
+        stack.push_back(left[node]);
+    }
+}
+
+std::vector<int> ds::Dendrogram::members(int node) const
+{
+    std::vector<int> vertices(leafOrder.begin() + leafBegin[node], leafOrder.begin() + leafBegin[node] + nodeSize[node]);
+    std::sort(vertices.begin(), vertices.end());
+    return vertices;
+}
 
-ds::MinimumCut::MinimumCut(std::vector<std::vector<double>> weight_, int n_) : weight(std::move(weight_)),
-                                                                               n(n_), nbNodes(n_), cuts(),
-                                                                               shrunk(), bin()
+std::vector<int> ds::Dendrogram::subtreeEdges(int node) const
 {
-    minCut();
+    std::vector<int> edges, stack(1, node);
+    while (!stack.empty())
+    {
+        int current = stack.back();
+        stack.pop_back();
+        if (isLeaf(current))
+            continue;
+        edges.push_back(nodeEdge(current));
+        stack.push_back(left[current]);
+        stack.push_back(right[current]);
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
 }
 
-void ds::MinimumCut::minCut()
+template <typename IsCluster>
+std::vector<int> ds::Dendrogram::topDown(IsCluster isCluster) const
 {
+    std::vector<int> nodes, stack(roots);
+    while (!stack.empty())
+    {
+        int node = stack.back();
+        stack.pop_back();
+        if (isLeaf(node) || isCluster(node))
+        {
+            nodes.push_back(node);
+            continue;
+        }
+        stack.push_back(left[node]);
+        stack.push_back(right[node]);
+    }
+    std::sort(nodes.begin(), nodes.end(), [this](int a, int b) { return nodeMinVertex[a] < nodeMinVertex[b]; });
+    return nodes;
+}
+
+std::vector<int> ds::Dendrogram::cut(double cutOff, int maxSize) const
+{
+    return topDown([&](int node) { return nodeHeight[node] < cutOff && (maxSize <= 0 || nodeSize[node] <= maxSize); });
+}
+
+std::vector<int> ds::Dendrogram::components(int nbEdges) const
+{
+    return topDown([&](int node) { return nodeEdge(node) < nbEdges; });
+}
+
+
+void ds::MinimumCut::compute(std::vector<std::vector<double>> & weight, int n_)
+{
+    n = n_;
+    nbNodes = n_;
     // Initialize aux vectors
-    shrunk = std::vector<bool> (n + 1, false);
+    shrunk.assign(n + 1, false);
     bin.resize(n + 1);
     for (int i = 0; i <= n; i++)
     {
-        bin[i].push_back(i);
+        bin[i].assign(1, i);
         weight[i][i] = 0.0;
     }
     // Computes the min cut among all st-cuts
     auto minVal = FLT_MAX;
-    cuts.clear();
+    nbCuts = 0;
     while (nbNodes > 1)
     {
-        auto cutAux = minCutPhase(1);
+        auto cutAux = minCutPhase(weight, 1);
         if (cutAux.second < minVal)
         {
-            cuts.clear();
+            nbCuts = 0;
             minVal = cutAux.second;
-            cuts.emplace_back(bin[cutAux.first], minVal);
+            addCut(cutAux.first, minVal);
         }
         else if (cutAux.second == minVal)
         {
-            cuts.emplace_back(bin[cutAux.first], minVal);
+            addCut(cutAux.first, minVal);
         }
     }
 }
 
-std::pair<int, double> ds::MinimumCut::minCutPhase(int arbitraryVertex)
+void ds::MinimumCut::addCut(int vertex, double cutValue)
+{
+    if (nbCuts == (int) cuts.size())
+        cuts.emplace_back();
+    cuts[nbCuts].first.assign(bin[vertex].begin(), bin[vertex].end());
+    cuts[nbCuts].second = cutValue;
+    nbCuts++;
+}
+
+std::pair<int, double> ds::MinimumCut::minCutPhase(std::vector<std::vector<double>> & weight, int arbitraryVertex)
 {
-    std::vector<bool> assigned(n + 1, false);
+    assigned.assign(n + 1, false);
     assigned[arbitraryVertex] = true;
     // Initial vertices weight
-    std::vector<double> vertexWeight(n + 1, 0.0);
+    vertexWeight.assign(n + 1, 0.0);
     for (int i = 1; i <= n; i++)
         if (!shrunk[i])
             vertexWeight[i] = weight[arbitraryVertex][i];
@@ -238,8 +553,9 @@ void ds::MinimumCut::printCuts()
     else
     {
         auto count = 1;
-        for (auto & cut : cuts)
+        for (int c = 0; c < nbCuts; c++)
         {
+            const auto & cut = cuts[c];
             std::cout << "Cut#" << count;
             for (auto i : cut.first)
                 std::cout << " " << i;
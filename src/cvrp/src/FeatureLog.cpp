@@ -0,0 +1,150 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#include "FeatureLog.h"
+
+#include <iostream>
+#include <utility>
+
+const char * const cvrp_joao::FeatureLog::featureIntColumns[] = {"nodeId", "depth", "firstNode", "secondNode",
+                                                                 "nbBranchingOn", "nbRoutesIn", "nbSBEval"};
+const char * const cvrp_joao::FeatureLog::featureRealColumns[] = {"fracValue", "avgFracValue", "cost", "reducedCost",
+                                                                  "distDepot", "distConvexHull", "distNearestNeighbor",
+                                                                  "sumDemandsEndpoints", "sumDemandsNeighbors"};
+const char * const cvrp_joao::FeatureLog::outcomeIntColumns[] = {"nodeId", "firstNode", "secondNode", "up"};
+const char * const cvrp_joao::FeatureLog::outcomeRealColumns[] = {"gain"};
+
+namespace
+{
+    template <typename T>
+    void writeValue(std::ofstream & ofs, const T & value) { ofs.write(reinterpret_cast<const char *>(&value), sizeof(T)); }
+
+    template <typename T>
+    void writeColumn(std::ofstream & ofs, const std::vector<T> & column)
+    {
+        ofs.write(reinterpret_cast<const char *>(column.data()), (std::streamsize) (column.size() * sizeof(T)));
+    }
+}
+
+bool cvrp_joao::FeatureLog::open(const std::string & fileName_)
+{
+    close();
+    fileName = fileName_;
+    file.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open the branching features file " << fileName << std::endl;
+        return false;
+    }
+    writeValue(file, (uint32_t) fileMagic);
+    writeValue(file, (uint32_t) fileVersion);
+
+    initBlock(featureBlock, FeatureBlock);
+    initBlock(outcomeBlock, OutcomeBlock);
+    closing = false;
+    nbRows = 0;
+    writer = std::thread(&FeatureLog::writerLoop, this);
+    return true;
+}
+
+void cvrp_joao::FeatureLog::addRow(BlockType type, const int32_t * intValues, const double * realValues)
+{
+    auto & block = (type == FeatureBlock) ? featureBlock : outcomeBlock;
+    for (size_t c = 0; c < block.intColumns.size(); c++)
+        block.intColumns[c].push_back(intValues[c]);
+    for (size_t c = 0; c < block.realColumns.size(); c++)
+        block.realColumns[c].push_back(realValues[c]);
+    nbRows++;
+    if (++block.nbRows == blockSize)
+        pushBlock(block);
+}
+
+void cvrp_joao::FeatureLog::close()
+{
+    if (!isOpen())
+        return;
+
+    if (featureBlock.nbRows > 0)
+        pushBlock(featureBlock);
+    if (outcomeBlock.nbRows > 0)
+        pushBlock(outcomeBlock);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    blockReady.notify_one();
+    writer.join();
+
+    file.close();
+    std::cout << "Branching features saved to " << fileName << ": " << nbRows << " row(s)" << std::endl;
+}
+
+void cvrp_joao::FeatureLog::initBlock(Block & block, BlockType type)
+{
+    block.type = type;
+    block.nbRows = 0;
+    block.intColumns.resize(type == FeatureBlock ? nbFeatureIntColumns : nbOutcomeIntColumns);
+    block.realColumns.resize(type == FeatureBlock ? nbFeatureRealColumns : nbOutcomeRealColumns);
+    for (auto & column : block.intColumns)
+    {
+        column.clear();
+        column.reserve(blockSize);
+    }
+    for (auto & column : block.realColumns)
+    {
+        column.clear();
+        column.reserve(blockSize);
+    }
+}
+
+// Hands the block to the writer and continues with a free one
+void cvrp_joao::FeatureLog::pushBlock(Block & block)
+{
+    auto type = block.type;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fullBlocks.push_back(std::move(block));
+        if (!freeBlocks.empty())
+        {
+            block = std::move(freeBlocks.front());
+            freeBlocks.pop_front();
+        }
+        else
+            block = Block();
+    }
+    blockReady.notify_one();
+    initBlock(block, type);
+}
+
+void cvrp_joao::FeatureLog::writeBlock(const Block & block)
+{
+    writeValue(file, (uint32_t) block.type);
+    writeValue(file, (int32_t) block.nbRows);
+    writeValue(file, (int32_t) block.intColumns.size());
+    writeValue(file, (int32_t) block.realColumns.size());
+    for (const auto & column : block.intColumns)
+        writeColumn(file, column);
+    for (const auto & column : block.realColumns)
+        writeColumn(file, column);
+}
+
+void cvrp_joao::FeatureLog::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        blockReady.wait(lock, [this]() { return !fullBlocks.empty() || closing; });
+        if (fullBlocks.empty())
+            break;
+
+        auto block = std::move(fullBlocks.front());
+        fullBlocks.pop_front();
+        lock.unlock();
+        writeBlock(block);
+        lock.lock();
+        freeBlocks.push_back(std::move(block));
+    }
+}
@@ -10,92 +10,214 @@
 
 #include <algorithm>
 
-void fracclu::FractionalClustering::loadFractionalClustering(double threshold_, int n)
+void fracclu::FractionalClustering::loadFractionalClustering(double threshold_, int n, int maxNbClusters_,
+                                                            int gracePeriod_)
 {
     setThresholdValue(threshold_);
+    maxNbClusters = maxNbClusters_;
+    gracePeriod = gracePeriod_;
     // Initializing depot '0'
+    vertexClusters = std::vector<std::vector<int>>(n);
     depotCluster.push_back(0);
-    clusters.emplace_back(1, depotCluster);
-    disjoint.emplace_back(std::vector<bool> (clusters.size() + 1, true));
-    disjoint.emplace_back(std::vector<bool> (clusters.size() + 1, true));
-    std::vector<bool> aux(n, false);
-    customerClusters.push_back(aux);
-    aux[0] = true;
-    customerClusters.push_back(aux);
+    insertCluster(registry.insert(depotCluster).first, depotCluster, n);
+    intersecting.emplace_back(1);
+    vertexClusters[0].push_back(0);
 }
 
 void fracclu::FractionalClustering::updateClustersList(const cvrp_joao::Data & data,
-                                                       const std::vector<std::vector<double>> & xSolution)
+                                                       const cvrp_joao::SparseXSolution & xSolution)
 {
+    nbCalls++;
+    evictedIds.clear();
     getNewClusters(data, xSolution);
     removeDuplicates();
     insertNewClusters(data.nbCustomers + 1);
 }
 
-void fracclu::FractionalClustering::getNewClusters(const cvrp_joao::Data & data, const std::vector<std::vector<double>> & xSolution)
+void fracclu::FractionalClustering::getNewClusters(const cvrp_joao::Data & data, const cvrp_joao::SparseXSolution & xSolution)
 {
     // Clear vector
     newClusters.clear();
     // Creating sets based on the fractional solution of the edges
-    ds::DisjointSets sets(data.nbCustomers);
-    for (int firstCustId = 1; firstCustId <= data.nbCustomers; ++firstCustId )
-        for (int secondCustId = firstCustId + 1; secondCustId <= data.nbCustomers; ++secondCustId)
-            if (xSolution[firstCustId][secondCustId] >= threshold)
-                sets.unionRank(firstCustId, secondCustId);
+    unionFind.reset(data.nbCustomers);
+    for (int e = 0; e < xSolution.nbEdges(); ++e)
+        if (xSolution.edgeFirstNode(e) != 0 && xSolution.edgeLPValue(e) >= threshold)
+            unionFind.unionRank(xSolution.edgeFirstNode(e), xSolution.edgeSecondNode(e));
 
-    newClusters = sets.getDisjointSets(data.nbCustomers);
+    auto nbSets = unionFind.groupSets(data.nbCustomers);
+    for (int k = 0; k < nbSets; k++)
+        newClusters.emplace_back(-1, std::vector<int>(unionFind.setBegin(k), unionFind.setEnd(k)));
 }
 
 void fracclu::FractionalClustering::removeDuplicates()
 {
-    auto clustersAux = newClusters;
+    auto clustersAux = std::move(newClusters);
     newClusters.clear();
-    // Checking for and removing duplicate clusters
-    for (auto & clu1: clustersAux)
+    // Checking for and removing duplicate clusters; the new ones, and the evicted ones found again, get the next ids
+    // in the registry
+    for (auto & clu: clustersAux)
     {
-        bool exists = false;
-        for (auto & clu2: clusters)
+        auto clustId = registry.insert(clu.second).first;
+        if (clustId >= (int) clusterSlot.size() || clusterSlot[clustId] == -1)
         {
-            if (ds::Utils::compare(clu1, clu2.second))
-            {
-                exists = true;
-                break;
-            }
+            newClusters.emplace_back(clustId, std::move(clu.second));
+            continue;
+        }
+
+        for (auto & pos : vertexClusters[clu.second.front()])
+            if (clusters[pos].first == clustId)
+                clusterStats[pos].lastUsed = nbCalls;
+    }
+}
+
+void fracclu::FractionalClustering::insertCluster(int clustId, const std::vector<int> & clust, int n)
+{
+    int slot;
+    if (freeSlots.empty())
+    {
+        slot = (int) customerClusters.size();
+        customerClusters.emplace_back(n);
+    }
+    else
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    if (clustId >= (int) clusterSlot.size())
+        clusterSlot.resize(clustId + 1, -1);
+    clusterSlot[clustId] = slot;
+
+    // Identifying customer multi-clusters
+    for (auto & i : clust)
+        customerClusters[slot].set(i);
+
+    clusters.emplace_back(clustId, clust);
+    clusterStats.push_back({0, 0, 0, nbCalls, nbCalls});
+}
+
+void fracclu::FractionalClustering::recordCandidate(int pos, bool selected)
+{
+    clusterStats[pos].nbFractional++;
+    if (selected)
+        clusterStats[pos].nbSelected++;
+    clusterStats[pos].lastUsed = nbCalls;
+}
+
+void fracclu::FractionalClustering::recordBranched(int clustId)
+{
+    if (clustId >= (int) clusterSlot.size() || clusterSlot[clustId] == -1)
+        return;
+
+    for (auto & pos : vertexClusters[registry.cluster(clustId).front()])
+        if (clusters[pos].first == clustId)
+        {
+            clusterStats[pos].nbBranched++;
+            clusterStats[pos].lastUsed = nbCalls;
+        }
+}
+
+int fracclu::FractionalClustering::evictClusters(int & firstNewCluster)
+{
+    auto nbClusters = (int) clusters.size();
+    if (maxNbClusters <= 0 || nbClusters <= maxNbClusters)
+        return 0;
+
+    // The least useful clusters are evicted first, and the least recently used among those with the same score.
+    // The depot cluster is never evicted, nor the clusters inserted in the last 'gracePeriod' calls (including the
+    // new ones), which had no chance to be candidates yet: the pool may then exceed its size for a few calls
+    std::vector<int> order;
+    for (int pos = 1; pos < firstNewCluster; pos++)
+        if (nbCalls - clusterStats[pos].insertedAt >= gracePeriod)
+            order.push_back(pos);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        if (clusterStats[a].score(nbCalls) != clusterStats[b].score(nbCalls))
+            return clusterStats[a].score(nbCalls) < clusterStats[b].score(nbCalls);
+        if (clusterStats[a].lastUsed != clusterStats[b].lastUsed)
+            return clusterStats[a].lastUsed < clusterStats[b].lastUsed;
+        return clusters[a].first < clusters[b].first;
+    });
+
+    auto nbToEvict = std::min(nbClusters - maxNbClusters, (int) order.size());
+    std::vector<bool> evicted(nbClusters, false);
+    for (int k = 0; k < nbToEvict; k++)
+    {
+        auto pos = order[k];
+        auto slot = clusterSlot[clusters[pos].first];
+        evicted[pos] = true;
+        clusterSlot[clusters[pos].first] = -1;
+        registry.erase(clusters[pos].first);
+        evictedIds.push_back(clusters[pos].first);
+        freeSlots.push_back(slot);
+        customerClusters[slot].clear();
+        intersecting[slot].clear();
+        for (auto & row : intersecting)
+            row.reset(slot);
+    }
+
+    // Compacting the pool, keeping the order of the remaining clusters
+    int nbKept = 0, nbOldKept = 0;
+    for (int pos = 0; pos < nbClusters; pos++)
+    {
+        if (evicted[pos])
+            continue;
+        if (pos < firstNewCluster)
+            nbOldKept++;
+        if (nbKept != pos)
+        {
+            clusters[nbKept] = std::move(clusters[pos]);
+            clusterStats[nbKept] = clusterStats[pos];
         }
-        if (!exists)
-            newClusters.push_back(clu1);
+        nbKept++;
     }
+    clusters.resize(nbKept);
+    clusterStats.resize(nbKept);
+    firstNewCluster = nbOldKept;
+
+    // The positions changed, so the membership lists of the remaining old clusters are rebuilt
+    for (auto & list : vertexClusters)
+        list.clear();
+    for (int pos = 0; pos < firstNewCluster; pos++)
+        for (auto & vertex : clusters[pos].second)
+            vertexClusters[vertex].push_back(pos);
+
+    return nbToEvict;
 }
 
 void fracclu::FractionalClustering::insertNewClusters(int n)
 {
     if (!newClusters.empty())
     {
+        auto firstNewCluster = (int) clusters.size();
         for (auto & clust: newClusters)
-        {
-            insertCluster(clust);
+            insertCluster(clust.first, clust.second, n);
 
-            // Identifying customer multi-clusters
-            std::vector<bool> aux(n, false);
-            for (auto & i : clust)
-                aux[i] = true;
-            customerClusters.push_back(aux);
-        }
+        auto nbSlots = (int) customerClusters.size();
+        for (auto & row : intersecting)
+            row.resize(nbSlots);
+        intersecting.resize(nbSlots, ds::Bitset(nbSlots));
+        auto nbEvictedNow = evictClusters(firstNewCluster);
 
-        // Checking for intersected clusters
-        for (auto & aux : disjoint)
-            aux.insert(aux.end(), newClusters.size(), true);
-        disjoint.insert(disjoint.end(), newClusters.size(), std::vector<bool> (clusters.size() + 1, true));
-        auto pos = (int) (clusters.size() - newClusters.size() + 1);
-        for (int i = 0; i < clusters.size(); i++)
+        // Checking for intersected clusters: a new cluster only intersects the clusters containing one of its
+        // vertices, so the membership lists of its vertices give them directly
+        auto nbClusters = (int) clusters.size();
+        for (int j = firstNewCluster; j < nbClusters; j++)
         {
-            auto k = std::max(pos, i+1);
-            for (int j = k; j < clusters.size(); j++)
-                if (ds::Utils::intersection(clusters[i].second, clusters[j].second))
-                    disjoint[clusters[i].first][clusters[j].first] = disjoint[clusters[j].first][clusters[i].first] = false;
+            auto secondSlot = clusterSlot[clusters[j].first];
+            for (auto & vertex : clusters[j].second)
+            {
+                for (auto & i : vertexClusters[vertex])
+                {
+                    auto firstSlot = clusterSlot[clusters[i].first];
+                    intersecting[firstSlot].set(secondSlot);
+                    intersecting[secondSlot].set(firstSlot);
+                }
+                vertexClusters[vertex].push_back(j);
+            }
         }
-        std::cout << "Added " << newClusters.size() << " cluster(s) to the list; list size = " << clusters.size() << std::endl;
-        printClusters(clusters);
+        std::cout << "Added " << newClusters.size() << " cluster(s) to the list; evicted " << nbEvictedNow
+                  << "; list size = " << clusters.size() << std::endl;
+        if (firstNewCluster < nbClusters)
+            printClusters(std::vector<std::pair<int,std::vector<int>>>(clusters.begin() + firstNewCluster, clusters.end()));
     }
     else
     {
@@ -32,11 +32,12 @@
 #include "Clustering.h"
 #include "FractionalClustering.h"
 #include "BranchingFeatures.h"
+#include "PseudoCosts.h"
 
 cvrp_joao::Loader::Loader() :
     data(Data::getInstance()), parameters(Parameters::getInstance()), subtree(Subtree::getInstance()),
     clustering(cluster::Clustering::getInstance()), fractionalClustering(fracclu::FractionalClustering::getInstance()),
-    branchingFeatures(BranchingFeatures::getInstance())
+    branchingFeatures(BranchingFeatures::getInstance()), pseudoCosts(PseudoCosts::getInstance())
 {}
 
 bool cvrp_joao::Loader::loadParameters(const std::string & file_name, int argc, char* argv[])
@@ -187,6 +188,7 @@ bool cvrp_joao::Loader::loadCVRPFile(std::ifstream & ifs)
         return false;
 
     data.nbCustomers = data.customers.size() - 1;
+    data.buildDistanceMatrix();
 
     std::cout << "CVRP data file detected" << std::endl;
 
@@ -200,7 +202,8 @@ void cvrp_joao::Loader::loadClustering()
 
 void cvrp_joao::Loader::loadFractionalClustering()
 {
-    fractionalClustering.loadFractionalClustering(parameters.thresholdValueFracClustering, data.nbCustomers + 1);
+    fractionalClustering.loadFractionalClustering(parameters.thresholdValueFracClustering, data.nbCustomers + 1,
+                                                  parameters.maxNbFracClusters, parameters.fracClustersGracePeriod);
 }
 
 void cvrp_joao::Loader::loadSubtree()
@@ -411,6 +414,23 @@ bool cvrp_joao::Loader::loadSubtreeFile(std::ifstream &ifs, Subtree & subtree_,
 
 void cvrp_joao::Loader::loadBranchingFeatures(int nbSBcandidates)
 {
-    if (parameters.enableBranchingFeatures())
-        branchingFeatures.loadBranchingFeatures(data, nbSBcandidates);
+    if (!parameters.enableBranchingFeatures())
+    {
+        if (!parameters.branchingScorerFile().empty())
+            std::cout << "The branching scorer requires the branching features: it is not used" << std::endl;
+        return;
+    }
+
+    branchingFeatures.loadBranchingFeatures(data, nbSBcandidates);
+    if (!parameters.branchingFeaturesFile().empty())
+        branchingFeatures.openFeatureLog(parameters.branchingFeaturesFile());
+    if (!parameters.branchingScorerFile().empty())
+        branchingFeatures.loadScorer(parameters.branchingScorerFile());
+}
+
+void cvrp_joao::Loader::loadBranchingHistory()
+{
+    pseudoCosts.loadPseudoCosts(parameters.pseudoCostReliability());
+    if (!parameters.branchingHistoryFile().empty())
+        pseudoCosts.load(parameters.branchingHistoryFile(), data);
 }
\ No newline at end of file
@@ -13,8 +13,10 @@
 #include "Parameters.h"
 #include "Loader.h"
 #include "BranchScore.h"
+#include "PseudoCosts.h"
 
 #include "Model.h"
+#include "Branching.h"
 #include "SolutionChecker.h"
 
 using namespace std;
@@ -32,6 +34,7 @@ int main(int argc, char** argv)
     loader.loadFractionalClustering();
     loader.loadSubtree();
     loader.loadBranchingFeatures(bapcodInit.param().StrongBranchingPhaseOneCandidatesNumber());
+    loader.loadBranchingHistory();
 
     cvrp_joao::SolutionChecker * sol_checker = new cvrp_joao::SolutionChecker;
 
@@ -42,6 +45,19 @@ int main(int argc, char** argv)
     bool feasibleSol = (solution.defined()) && sol_checker->isFeasible(solution, true, true, true);
 
     bapcodInit.outputBaPCodStatistics(bapcodInit.instanceFile());
+    cvrp_joao::BranchingFeatures::getInstance().closeFeatureLog();
+
+    /// The history is only saved if something was learned, and never over a file that could not be loaded
+    const auto & historyFile = cvrp_joao::Parameters::getInstance().branchingHistoryFile();
+    if (!historyFile.empty() && cvrp_joao::Parameters::getInstance().pseudoCostReliability() > 0)
+    {
+        if (cvrp_joao::PseudoCosts::getInstance().isHistoryRejected())
+            std::cout << "Branching history not saved: " << historyFile << " was not loaded" << std::endl;
+        else
+            cvrp_joao::PseudoCosts::getInstance().save(historyFile, cvrp_joao::Data::getInstance());
+    }
+
+    cvrp_joao::UserBranchingFunctor::printCacheStatistics();
 
     double rootGap = (bapcodInit.getStatisticValue("bcRecBestInc") - bapcodInit.getStatisticValue("bcRecRootDb"))
                      / bapcodInit.getStatisticValue("bcRecRootDb");
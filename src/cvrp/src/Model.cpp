@@ -112,13 +112,12 @@ cvrp_joao::Model::Model(const BcInitialisation& bc_init) : BcModel(bc_init, bc_i
             if (firstCustId == 0)
             {
                 if (params.enableVNB()) vehNumberBranching[0] += 0.5 * bcVar;
-                objective += data.getDepotToCustDistance(secondCustId) * bcVar;
             }
             else
             {
                 degreeConstr[firstCustId] += bcVar;
-                objective += data.getCustToCustDistance(firstCustId, secondCustId) * bcVar;
             }
+            objective += data.getNodeToNodeDistance(firstCustId, secondCustId) * bcVar;
             degreeConstr[secondCustId] += bcVar;
             if (!params.enableCostlyEdgeBranching() && params.enableEdgeBranching())
                 edgeBranching[firstCustId][secondCustId] += bcVar;
@@ -151,7 +150,8 @@ cvrp_joao::Model::Model(const BcInitialisation& bc_init) : BcModel(bc_init, bc_i
         if (params.enableClusterBranching()) std::cout << "Cluster branching ENABLED" << std::endl;
         if (params.enableCutsetsBranching()) std::cout << "Cutsets branching ENABLED" << std::endl;
         userBranching.attach(
-                new UserBranchingFunctor(data, params, clustering, fractionalClustering, branchingFeatures));
+                new UserBranchingFunctor(data, params, clustering, fractionalClustering, branchingFeatures,
+                                         pseudoCosts));
     }
     else if (!params.enableEdgeBranching() && !params.enableRyanFoster())
     {
@@ -36,6 +36,8 @@ cvrp_joao::Parameters::Parameters() :
         enableCostlyEdgeBranching("enableCostlyEdgeBranching", false),
         enableEdgeBranching("enableEdgeBranching", true),
         enableRandomSBCandidates("enableRandomSBCandidates", false),
+        edgeBranchingPriority("edgeBranchingPriority", 0.9,
+                              "Weight of the scores of the edge candidates against those of the other families"),
         enableClusterBranching("enableClusterBranching", false),
         enableCutsetsBranching("enableCutsetsBranching", false),
         clusterBranchingMode("clusterBranchingMode", 1,
@@ -49,14 +51,26 @@ cvrp_joao::Parameters::Parameters() :
         routeClusterFilePath("routeClusterFilePath","","Routes file path (CVRP solution format)"),
         enableSingletons("enableSingletons", true),
         enableBigClusters("enableBigClusters", false),
+        enableSparseMST("enableSparseMST", false),
         stDevMultiplier("stDevMultiplier", -1.0),
         stDevMultiplierTSP("stDevMultiplierTSP", -1.0),
         decreasingStepStDev("decreasingStepStDev", -1.0),
         bigClustersSizeThreshold("bigClustersSizeThreshold", -1.0),
         enableFracClustering("enableFracClustering", false),
         thresholdValueFracClustering("thresholdValueFracClustering", 0.5),
+        maxNbFracClusters("maxNbFracClusters", 0, "Max. nb. of fractional clusters kept in the pool (0 = no limit)"),
+        fracClustersGracePeriod("fracClustersGracePeriod", 5,
+                                "Nb. of calls after its insertion during which a fractional cluster is not evicted"),
         enableMinCut("enableMinCut", false),
         enableBranchingFeatures("enableBranchingFeatures", false),
+        branchingVerbose("branchingVerbose", false, "Prints the diagnostics of the branching functor at each node"),
+        pseudoCostReliability("pseudoCostReliability", 0,
+                              "Nb. of observed branches in each direction for a reliable pseudo-cost (0 = no pseudo-costs)"),
+        pseudoCostPruning("pseudoCostPruning", false,
+                          "Skips the strong branching of the candidates ranked after the first reliable one"),
+        branchingHistoryFile("branchingHistoryFile", "", "Binary file of the branching history, loaded at start and saved at the end"),
+        branchingFeaturesFile("branchingFeaturesFile", "", "Binary columnar log of the branching features (printed if empty)"),
+        branchingScorerFile("branchingScorerFile", "", "Learned model ranking the edge branching candidates"),
         rootFracSolutionFilePath("rootFracSolutionFilePath", "", "File to save the root frac. solution")
 {}
 
@@ -82,6 +96,7 @@ bool cvrp_joao::Parameters::loadParameters(const std::string & parameterFileName
     addApplicationParameter(enableCostlyEdgeBranching);
     addApplicationParameter(enableEdgeBranching);
     addApplicationParameter(enableRandomSBCandidates);
+    addApplicationParameter(edgeBranchingPriority);
 
     addApplicationParameter(enableClusterBranching);
     addApplicationParameter(clusterBranchingMode);
@@ -93,6 +108,7 @@ bool cvrp_joao::Parameters::loadParameters(const std::string & parameterFileName
     addApplicationParameter(routeClusterFilePath);
     addApplicationParameter(enableSingletons);
     addApplicationParameter(enableBigClusters);
+    addApplicationParameter(enableSparseMST);
 
     addApplicationParameter(enableCutsetsBranching);
 
@@ -103,9 +119,17 @@ bool cvrp_joao::Parameters::loadParameters(const std::string & parameterFileName
 
     addApplicationParameter(enableFracClustering);
     addApplicationParameter(thresholdValueFracClustering);
+    addApplicationParameter(maxNbFracClusters);
+    addApplicationParameter(fracClustersGracePeriod);
 
     addApplicationParameter(enableMinCut);
     addApplicationParameter(enableBranchingFeatures);
+    addApplicationParameter(branchingVerbose);
+    addApplicationParameter(pseudoCostReliability);
+    addApplicationParameter(pseudoCostPruning);
+    addApplicationParameter(branchingHistoryFile);
+    addApplicationParameter(branchingFeaturesFile);
+    addApplicationParameter(branchingScorerFile);
 
     addApplicationParameter(rootFracSolutionFilePath);
 
@@ -0,0 +1,55 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#include "PendingBranchings.h"
+
+void cvrp_joao::PendingBranching::addCandidate(const int * signatureFirst, const int * signatureLast, double value,
+                                               std::pair<int, int> edge, std::pair<int, int> fracClusterIds)
+{
+    signatureArena.insert(signatureArena.end(), signatureFirst, signatureLast);
+    signatureStart.push_back((int) signatureArena.size());
+    values.push_back(value);
+    edges.push_back(edge);
+    fracClusters.push_back(fracClusterIds);
+    nbCandidates++;
+}
+
+cvrp_joao::PendingBranching & cvrp_joao::PendingBranchings::next(int nodeId, int depth, double lpValue)
+{
+    // There is always a free record, as at most maxSize of the maxSize + 1 records are pending
+    nextRecord = 0;
+    while (records[nextRecord].active)
+        nextRecord++;
+
+    auto & record = records[nextRecord];
+    record.nodeId = nodeId;
+    record.depth = depth;
+    record.lpValue = lpValue;
+    record.nbCandidates = 0;
+    record.signatureArena.clear();
+    record.signatureStart.assign(1, 0);
+    record.values.clear();
+    record.edges.clear();
+    record.fracClusters.clear();
+    record.branched = -1;
+    record.downSeen = false;
+    record.upSeen = false;
+    return record;
+}
+
+void cvrp_joao::PendingBranchings::push()
+{
+    records[nextRecord].active = true;
+    order.push_back(nextRecord);
+    if ((int) order.size() > maxSize)
+        erase(0);
+}
+
+void cvrp_joao::PendingBranchings::erase(int k)
+{
+    records[order[k]].active = false;
+    order.erase(order.begin() + k);
+}
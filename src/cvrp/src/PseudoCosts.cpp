@@ -0,0 +1,213 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#include "PseudoCosts.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // File layout: magic, version, nb. of customers, instance fingerprint, nb. of entries, and for each entry its
+    // signature (size and elements) followed by its statistics
+    const uint32_t historyFileMagic = 0x48425643; // "CVBH"
+    const uint32_t historyFileVersion = 2;
+
+    template <typename T>
+    void writeValue(std::ofstream & ofs, const T & value) { ofs.write(reinterpret_cast<const char *>(&value), sizeof(T)); }
+
+    template <typename T>
+    bool readValue(std::ifstream & ifs, T & value) { return (bool) ifs.read(reinterpret_cast<char *>(&value), sizeof(T)); }
+}
+
+// FNV-1a over the capacity and the coordinates and demands of the depot and the customers
+uint64_t cvrp_joao::PseudoCosts::getInstanceFingerprint(const Data & data)
+{
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](uint64_t value) {
+        h ^= value;
+        h *= 1099511628211ULL;
+    };
+    auto mixReal = [&mix](double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        mix(bits);
+    };
+    mix((uint64_t) (uint32_t) data.nbCustomers);
+    mix((uint64_t) (uint32_t) data.veh_capacity);
+    mixReal(data.depot_x);
+    mixReal(data.depot_y);
+    for (int i = 1; i <= data.nbCustomers; i++)
+    {
+        mixReal(data.customers[i].x);
+        mixReal(data.customers[i].y);
+        mix((uint64_t) (uint32_t) data.customers[i].demand);
+    }
+    return h;
+}
+
+int cvrp_joao::PseudoCosts::getId(const std::vector<int> & signature)
+{
+    auto id = registry.insert(signature).first;
+    if (id >= (int) entries.size())
+        entries.push_back({0.0, 0.0, 0, 0, 0, 0});
+    return id;
+}
+
+void cvrp_joao::PseudoCosts::update(const std::vector<int> & signature, bool up, double unitGain)
+{
+    auto & entry = entries[getId(signature)];
+    if (up)
+    {
+        entry.sumUp += unitGain;
+        entry.nbUp++;
+        sumUp += unitGain;
+        nbUp++;
+    }
+    else
+    {
+        entry.sumDown += unitGain;
+        entry.nbDown++;
+        sumDown += unitGain;
+        nbDown++;
+    }
+}
+
+bool cvrp_joao::PseudoCosts::isReliable(int id) const
+{
+    return id != -1 && std::min(entries[id].nbDown, entries[id].nbUp) >= reliabilityThreshold;
+}
+
+double cvrp_joao::PseudoCosts::score(int id, double fractionalPart) const
+{
+    const double epsilon = 1e-6;
+    double avgDown = (nbDown > 0) ? sumDown / nbDown : 1.0;
+    double avgUp = (nbUp > 0) ? sumUp / nbUp : 1.0;
+    double down = avgDown, up = avgUp;
+    if (id != -1)
+    {
+        const auto & entry = entries[id];
+        if (entry.nbDown > 0)
+            down = entry.sumDown / entry.nbDown;
+        if (entry.nbUp > 0)
+            up = entry.sumUp / entry.nbUp;
+    }
+
+    return std::max(down * fractionalPart, epsilon) * std::max(up * (1.0 - fractionalPart), epsilon);
+}
+
+bool cvrp_joao::PseudoCosts::load(const std::string & fileName, const Data & data)
+{
+    auto nbCustomers = data.nbCustomers;
+    std::ifstream ifs(fileName, std::ios::binary);
+    if (!ifs.is_open())
+    {
+        std::cout << "Branching history file " << fileName << " not found: starting without history" << std::endl;
+        return false;
+    }
+    historyRejected = true;
+
+    uint32_t magic = 0, version = 0;
+    int32_t fileNbCustomers = 0, nbEntries = 0;
+    uint64_t fingerprint = 0;
+    if (!readValue(ifs, magic) || !readValue(ifs, version) || magic != historyFileMagic
+        || version != historyFileVersion || !readValue(ifs, fileNbCustomers) || !readValue(ifs, fingerprint)
+        || !readValue(ifs, nbEntries))
+    {
+        std::cerr << "Invalid branching history file " << fileName << std::endl;
+        return false;
+    }
+    if (fileNbCustomers != nbCustomers)
+    {
+        std::cerr << "Branching history file " << fileName << " is for an instance with " << fileNbCustomers
+                  << " customers: ignored" << std::endl;
+        return false;
+    }
+    if (fingerprint != getInstanceFingerprint(data))
+    {
+        std::cerr << "Branching history file " << fileName << " is for another instance: ignored" << std::endl;
+        return false;
+    }
+
+    std::vector<int> signature;
+    for (int k = 0; k < nbEntries; k++)
+    {
+        int32_t size = 0;
+        Entry entry{};
+        if (!readValue(ifs, size) || size < 0 || size > 2 * (nbCustomers + 1) + 1)
+        {
+            std::cerr << "Truncated branching history file " << fileName << std::endl;
+            return false;
+        }
+        signature.resize(size);
+        bool ok = true;
+        for (auto & i : signature)
+        {
+            int32_t value = 0;
+            ok = ok && readValue(ifs, value);
+            i = value;
+        }
+        ok = ok && readValue(ifs, entry.sumDown) && readValue(ifs, entry.sumUp) && readValue(ifs, entry.nbDown)
+             && readValue(ifs, entry.nbUp) && readValue(ifs, entry.nbEvaluated) && readValue(ifs, entry.nbBranched);
+        if (!ok)
+        {
+            std::cerr << "Truncated branching history file " << fileName << std::endl;
+            return false;
+        }
+
+        auto & current = entries[getId(signature)];
+        current.sumDown += entry.sumDown;
+        current.sumUp += entry.sumUp;
+        current.nbDown += entry.nbDown;
+        current.nbUp += entry.nbUp;
+        current.nbEvaluated += entry.nbEvaluated;
+        current.nbBranched += entry.nbBranched;
+        sumDown += entry.sumDown;
+        sumUp += entry.sumUp;
+        nbDown += entry.nbDown;
+        nbUp += entry.nbUp;
+    }
+
+    std::cout << "Branching history loaded from " << fileName << ": " << nbEntries << " constraint(s)" << std::endl;
+    historyRejected = false;
+    return true;
+}
+
+bool cvrp_joao::PseudoCosts::save(const std::string & fileName, const Data & data) const
+{
+    std::ofstream ofs(fileName, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open())
+    {
+        std::cerr << "Failed to open the branching history file " << fileName << std::endl;
+        return false;
+    }
+
+    writeValue(ofs, historyFileMagic);
+    writeValue(ofs, historyFileVersion);
+    writeValue(ofs, (int32_t) data.nbCustomers);
+    writeValue(ofs, getInstanceFingerprint(data));
+    writeValue(ofs, (int32_t) entries.size());
+    for (int id = 0; id < (int) entries.size(); id++)
+    {
+        const auto & signature = registry.cluster(id);
+        writeValue(ofs, (int32_t) signature.size());
+        for (const auto & i : signature)
+            writeValue(ofs, (int32_t) i);
+        const auto & entry = entries[id];
+        writeValue(ofs, entry.sumDown);
+        writeValue(ofs, entry.sumUp);
+        writeValue(ofs, entry.nbDown);
+        writeValue(ofs, entry.nbUp);
+        writeValue(ofs, entry.nbEvaluated);
+        writeValue(ofs, entry.nbBranched);
+    }
+
+    std::cout << "Branching history saved to " << fileName << ": " << entries.size() << " constraint(s)" << std::endl;
+    return (bool) ofs;
+}
@@ -0,0 +1,116 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+#include "SparseXSolution.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+cvrp_joao::SparseXSolution::SparseXSolution(int nbNodes_) : nNodes(0), edgeFirst(), edgeSecond(), edgeValue(),
+                                                            rowStart(), adjNodes(), adjValues(), order(), nodeAux(), valueAux(), fillPos()
+{
+    clear(nbNodes_);
+}
+
+void cvrp_joao::SparseXSolution::clear(int nbNodes_)
+{
+    nNodes = nbNodes_;
+    edgeFirst.clear();
+    edgeSecond.clear();
+    edgeValue.clear();
+    rowStart.assign(nNodes + 1, 0);
+    adjNodes.clear();
+    adjValues.clear();
+}
+
+void cvrp_joao::SparseXSolution::addEdge(int i, int j, double value)
+{
+    if (value <= 0)
+        return;
+
+    edgeFirst.push_back(std::min(i, j));
+    edgeSecond.push_back(std::max(i, j));
+    edgeValue.push_back(value);
+}
+
+void cvrp_joao::SparseXSolution::finalize()
+{
+    // Sorting the edges by (i,j)
+    auto nbEdges_ = (int) edgeValue.size();
+    order.resize(nbEdges_);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return std::make_pair(edgeFirst[a], edgeSecond[a]) < std::make_pair(edgeFirst[b], edgeSecond[b]);
+    });
+    bool sorted = true;
+    for (int e = 0; e < nbEdges_ && sorted; e++)
+        sorted = (order[e] == e);
+    if (!sorted)
+    {
+        // Permuting through the auxiliary buffers, which are swapped in and kept for the next call
+        nodeAux.resize(nbEdges_);
+        for (int e = 0; e < nbEdges_; e++)
+            nodeAux[e] = edgeFirst[order[e]];
+        edgeFirst.swap(nodeAux);
+        nodeAux.resize(nbEdges_);
+        for (int e = 0; e < nbEdges_; e++)
+            nodeAux[e] = edgeSecond[order[e]];
+        edgeSecond.swap(nodeAux);
+        valueAux.resize(nbEdges_);
+        for (int e = 0; e < nbEdges_; e++)
+            valueAux[e] = edgeValue[order[e]];
+        edgeValue.swap(valueAux);
+    }
+
+    // Counting pass, then filling both directions. As edges are sorted by (i,j), the neighbors of each node
+    // are written in increasing order: first those j < i (as second node), then those j > i (as first node)
+    rowStart.assign(nNodes + 1, 0);
+    for (int e = 0; e < nbEdges_; e++)
+    {
+        rowStart[edgeFirst[e] + 1]++;
+        rowStart[edgeSecond[e] + 1]++;
+    }
+    for (int i = 0; i < nNodes; i++)
+        rowStart[i + 1] += rowStart[i];
+
+    adjNodes.resize(2 * nbEdges_);
+    adjValues.resize(2 * nbEdges_);
+    fillPos.assign(rowStart.begin(), rowStart.end() - 1);
+    for (int e = 0; e < nbEdges_; e++)
+    {
+        int k = fillPos[edgeSecond[e]]++;
+        adjNodes[k] = edgeFirst[e];
+        adjValues[k] = edgeValue[e];
+    }
+    for (int e = 0; e < nbEdges_; e++)
+    {
+        int k = fillPos[edgeFirst[e]]++;
+        adjNodes[k] = edgeSecond[e];
+        adjValues[k] = edgeValue[e];
+    }
+}
+
+double cvrp_joao::SparseXSolution::value(int i, int j) const
+{
+    if (degree(j) < degree(i))
+        std::swap(i, j);
+
+    auto first = adjNodes.begin() + rowStart[i], last = adjNodes.begin() + rowStart[i + 1];
+    auto it = std::lower_bound(first, last, j);
+    if (it != last && *it == j)
+        return adjValues[it - adjNodes.begin()];
+    return 0.0;
+}
+
+void cvrp_joao::SparseXSolution::toDense(std::vector<std::vector<double>> & xDense) const
+{
+    xDense.resize(nNodes);
+    for (auto & row : xDense)
+        row.assign(nNodes, 0.0);
+    for (int e = 0; e < nbEdges(); e++)
+        xDense[edgeFirst[e]][edgeSecond[e]] = xDense[edgeSecond[e]][edgeFirst[e]] = edgeValue[e];
+}
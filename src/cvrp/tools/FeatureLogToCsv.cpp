@@ -0,0 +1,164 @@
+/*
+ *  Dependencies:
+ *  - BaPCod v0.82.5
+ *  - VRPSolver extension (RCSP solver) v0.6.10
+ */
+
+// Converts a branching features log (parameter branchingFeaturesFile) to CSV, with one line per (node, candidate edge).
+// The outcomes of the nodes branched on an edge are joined to its row: the dual bound gains of the down and up
+// children and their product score (empty when a child was not observed).
+// Built with the application (CMake target FeatureLogToCsv), or from the application folder:
+//     g++ -std=c++14 -O2 -I include tools/FeatureLogToCsv.cpp src/FeatureLog.cpp -pthread
+// Usage: FeatureLogToCsv <features file> [<csv file>]
+
+#include "FeatureLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+using cvrp_joao::FeatureLog;
+
+namespace
+{
+    struct Block
+    {
+        uint32_t type;
+        int nbRows;
+        std::vector<std::vector<int32_t>> intColumns;
+        std::vector<std::vector<double>> realColumns;
+    };
+
+    template <typename T>
+    bool readValue(std::ifstream & ifs, T & value) { return (bool) ifs.read(reinterpret_cast<char *>(&value), sizeof(T)); }
+
+    template <typename T>
+    bool readColumn(std::ifstream & ifs, std::vector<T> & column, int nbRows)
+    {
+        column.resize(nbRows);
+        return (bool) ifs.read(reinterpret_cast<char *>(column.data()), (std::streamsize) (nbRows * sizeof(T)));
+    }
+
+    bool readBlock(std::ifstream & ifs, Block & block)
+    {
+        int32_t nbIntColumns, nbRealColumns;
+        if (!readValue(ifs, block.type))
+            return false;
+        if (!readValue(ifs, block.nbRows) || !readValue(ifs, nbIntColumns) || !readValue(ifs, nbRealColumns)
+            || block.nbRows < 0 || nbIntColumns < 0 || nbRealColumns < 0)
+        {
+            std::cerr << "Truncated block header" << std::endl;
+            return false;
+        }
+        block.intColumns.resize(nbIntColumns);
+        block.realColumns.resize(nbRealColumns);
+        for (auto & column : block.intColumns)
+            if (!readColumn(ifs, column, block.nbRows))
+            {
+                std::cerr << "Truncated block" << std::endl;
+                return false;
+            }
+        for (auto & column : block.realColumns)
+            if (!readColumn(ifs, column, block.nbRows))
+            {
+                std::cerr << "Truncated block" << std::endl;
+                return false;
+            }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <features file> [<csv file>]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream ifs(argv[1], std::ios::binary);
+    uint32_t magic = 0, version = 0;
+    if (!ifs.is_open() || !readValue(ifs, magic) || !readValue(ifs, version) || magic != FeatureLog::fileMagic
+        || version != FeatureLog::fileVersion)
+    {
+        std::cerr << "Invalid branching features file " << argv[1] << std::endl;
+        return 1;
+    }
+
+    /// The feature blocks are kept, and the outcomes are indexed by (node, edge) to be joined to the feature rows
+    std::vector<Block> featureBlocks;
+    /// (down gain, up gain), NaN for a child that was not observed (the recorded gains are never negative, but
+    /// that is not relied on)
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    std::map<std::tuple<int, int, int>, std::pair<double, double>> outcomes;
+    Block block;
+    while (readBlock(ifs, block))
+    {
+        if (block.type == FeatureLog::FeatureBlock && block.intColumns.size() == FeatureLog::nbFeatureIntColumns
+            && block.realColumns.size() == FeatureLog::nbFeatureRealColumns)
+            featureBlocks.push_back(block);
+        else if (block.type == FeatureLog::OutcomeBlock && block.intColumns.size() == FeatureLog::nbOutcomeIntColumns
+                 && block.realColumns.size() == FeatureLog::nbOutcomeRealColumns)
+        {
+            for (int r = 0; r < block.nbRows; r++)
+            {
+                auto key = std::make_tuple(block.intColumns[0][r], block.intColumns[1][r], block.intColumns[2][r]);
+                auto it = outcomes.emplace(key, std::make_pair(missing, missing)).first;
+                (block.intColumns[3][r] ? it->second.second : it->second.first) = block.realColumns[0][r];
+            }
+        }
+        else
+            std::cerr << "Unknown block of type " << block.type << " skipped" << std::endl;
+    }
+
+    FILE * out = (argc > 2) ? fopen(argv[2], "w") : stdout;
+    if (out == nullptr)
+    {
+        std::cerr << "Failed to open " << argv[2] << std::endl;
+        return 1;
+    }
+    for (int c = 0; c < FeatureLog::nbFeatureIntColumns; c++)
+        fprintf(out, "%s,", FeatureLog::featureIntColumns[c]);
+    for (int c = 0; c < FeatureLog::nbFeatureRealColumns; c++)
+        fprintf(out, "%s,", FeatureLog::featureRealColumns[c]);
+    fprintf(out, "downGain,upGain,sbScore\n");
+
+    long nbRows = 0, nbLabeled = 0;
+    for (const auto & features : featureBlocks)
+        for (int r = 0; r < features.nbRows; r++)
+        {
+            for (const auto & column : features.intColumns)
+                fprintf(out, "%d,", column[r]);
+            for (const auto & column : features.realColumns)
+                fprintf(out, "%.10g,", column[r]);
+
+            auto it = outcomes.find(std::make_tuple(features.intColumns[0][r], features.intColumns[2][r],
+                                                    features.intColumns[3][r]));
+            double down = (it != outcomes.end()) ? it->second.first : missing;
+            double up = (it != outcomes.end()) ? it->second.second : missing;
+            if (!std::isnan(down))
+                fprintf(out, "%.10g", down);
+            fprintf(out, ",");
+            if (!std::isnan(up))
+                fprintf(out, "%.10g", up);
+            fprintf(out, ",");
+            if (!std::isnan(down) && !std::isnan(up))
+            {
+                fprintf(out, "%.10g", std::max(down, 1e-6) * std::max(up, 1e-6));
+                nbLabeled++;
+            }
+            fprintf(out, "\n");
+            nbRows++;
+        }
+    if (out != stdout)
+        fclose(out);
+
+    std::cerr << nbRows << " row(s), " << nbLabeled << " with both outcomes" << std::endl;
+    return 0;
+}
@@ -38,18 +38,23 @@ namespace ds
     };
 
 
+    // Union-find over the elements 1..n (union by rank, iterative path halving). It can be reset and reused
+    // without reallocation as long as n does not grow
     class DisjointSets : public Utils
     {
     public:
-        explicit DisjointSets(int n);
+        explicit DisjointSets(int n = 0);
+        void reset(int n);
         int findParent(int i);
         void unionRank(int x, int y);
         void printDisjointSets(int firstSetId = 1);
+        // Sets ordered by their smallest element, each one sorted, in O(n)
         std::vector<std::vector<int>> getDisjointSets(int n, bool verbose = false, int firstSetId = 1);
 
     private:
-        int* parent;
-        int* rank;
+        std::vector<int> parent;
+        std::vector<int> rank;
+        std::vector<int> setIndex;
         std::vector<std::vector<int>> sets;
     };
 
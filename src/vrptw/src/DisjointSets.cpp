@@ -55,21 +55,24 @@ bool ds::Utils::intersection(std::vector<int> & vec1, std::vector<int> & vec2)
 }
 
 
-ds::DisjointSets::DisjointSets(int n) : parent(new int[n+1]), rank(new int[n+1]), sets()
+ds::DisjointSets::DisjointSets(int n) : parent(), rank(), setIndex(), sets()
 {
-    for (int i = 1; i < n + 1; i++)
-    {
-        parent[i] = -1;
-        rank[i] = 1;
-    }
+    reset(n);
 }
 
-int ds::DisjointSets::findParent(int i)
+void ds::DisjointSets::reset(int n)
 {
-    if (parent[i] == -1)
-        return i;
+    parent.resize(n + 1);
+    rank.assign(n + 1, 1);
+    for (int i = 0; i <= n; i++)
+        parent[i] = i;
+}
 
-    return parent[i] = findParent(parent[i]);
+int ds::DisjointSets::findParent(int i)
+{
+    while (parent[i] != i)
+        i = parent[i] = parent[parent[i]];
+    return i;
 }
 
 void ds::DisjointSets::unionRank(int x, int y)
@@ -107,25 +110,26 @@ void ds::DisjointSets::printDisjointSets(int firstSetId) {
 
 std::vector<std::vector<int>> ds::DisjointSets::getDisjointSets(int n, bool verbose, int firstSetId)
 {
-    sets.clear();
-    std::vector<bool> inSet(n+1, false);
-    for (int firstVertex = 1; firstVertex <= n; firstVertex++) {
-        if (inSet[firstVertex]) continue;
-        std::vector<int> setAux;
-        setAux.push_back(firstVertex);
-        inSet[firstVertex] = true;
-
-        for (int secondVertex = firstVertex + 1; secondVertex <= n ; secondVertex++)
+    // Counting pass: the sets are numbered in the order of their smallest element, then filled in increasing order
+    setIndex.assign(n + 1, -1);
+    std::vector<int> setSize;
+    for (int vertex = 1; vertex <= n; vertex++)
+    {
+        int root = findParent(vertex);
+        if (setIndex[root] == -1)
         {
-            if (findParent(firstVertex) == findParent(secondVertex))
-            {
-                setAux.push_back(secondVertex);
-                inSet[secondVertex] = true;
-            }
+            setIndex[root] = (int) setSize.size();
+            setSize.push_back(0);
         }
-        sets.push_back(setAux);
+        setSize[setIndex[root]]++;
     }
 
+    sets.assign(setSize.size(), std::vector<int>());
+    for (int k = 0; k < (int) setSize.size(); k++)
+        sets[k].reserve(setSize[k]);
+    for (int vertex = 1; vertex <= n; vertex++)
+        sets[setIndex[findParent(vertex)]].push_back(vertex);
+
     if (verbose)
         printDisjointSets(firstSetId);
 
@@ -120,6 +120,7 @@ bool vrptw::Loader::loadVRPTWFile(std::ifstream & ifs)
         return false;
 
     data.nbCustomers = data.customers.size() - 1;
+    data.buildDistanceMatrix();
     data.minNumVehicles = std::ceil(sumDemand/data.veh_capacity);
 
     std::cout << "VRPTW data file detected" << std::endl;
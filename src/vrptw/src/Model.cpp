@@ -118,13 +118,12 @@ vrptw::Model::Model(const BcInitialisation& bc_init) : BcModel(bc_init, bc_init.
             if (firstCustId == 0)
             {
                 if (params.enableVNB()) vehNumberBranching[0] += 0.5 * bcVar;
-                objective += data.getDepotToCustDistance(secondCustId) * bcVar;
             }
             else
             {
                 degreeConstr[firstCustId] += bcVar;
-                objective += data.getCustToCustDistance(firstCustId, secondCustId) * bcVar;
             }
+            objective += data.getNodeToNodeDistance(firstCustId, secondCustId) * bcVar;
             degreeConstr[secondCustId] += bcVar;
             if (params.enableEdgeBranching()) edgeBranching[firstCustId][secondCustId] += bcVar;
         }
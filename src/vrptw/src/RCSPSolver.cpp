@@ -120,8 +120,11 @@ void vrptw::RCSPSolver::buildElemSetDistanceMatrix(BcNetwork & network)
     std::vector<std::vector<double> > distanceMatrix(nbElemSets, std::vector<double>(nbElemSets, 1e12));
 
     for (int firstCustId = 1; firstCustId <= data.nbCustomers; ++firstCustId )
+    {
+        auto & row = distanceMatrix[firstCustId];
         for (int secondCustId = 1; secondCustId <= data.nbCustomers; ++secondCustId)
-            distanceMatrix[firstCustId][secondCustId] = data.getCustToCustDistance(firstCustId, secondCustId);
+            row[secondCustId] = data.getNodeToNodeDistance(firstCustId, secondCustId);
+    }
 
     network.setElemSetsDistanceMatrix(distanceMatrix);
 }